@@ -0,0 +1,108 @@
+#ifndef AOC_H
+#define AOC_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+// An alternative, faster solver for a day. The day's own parse/part1/part2 are the reference
+// implementation; aoc_check makes sure every variant gives the same answers. Without a `parse`
+// the variant runs on the reference parse result and a NULL part falls back to the reference;
+// a variant with its own `parse` must provide both parts.
+typedef struct {
+    const char* name;
+
+    size_t (*part1)(const void* data);
+    size_t (*part2)(const void* data);
+
+    void* (*parse)(const char* path);
+    void (*release)(void* data);
+
+    // only set for variants that take `-o key=value` options: sets one, false for an option it
+    // doesn't know, and configure(NULL) puts them all back to their defaults; `options` is the
+    // help text listing them
+    bool (*configure)(const char* option);
+    const char* options;
+
+    // NULL-terminated option sets, space separated, that aoc_check also runs the variant with; the
+    // answers must match the variant's with `check_against` added to the set as well, or the
+    // reference's without a `check_against`
+    const char* const* checks;
+    const char* check_against;
+} AocVariant;
+
+// Common interface every day exposes so the `aoc` runner can drive all of
+// them from a single binary. `data` is whatever the day's `parse` returned.
+typedef struct {
+    const char* name;
+
+    void* (*parse)(const char* path);
+    size_t (*part1)(const void* data);
+    size_t (*part2)(const void* data);
+    void (*release)(void* data);
+
+    // only set when part 2 reads the input differently (day06)
+    void* (*parse_part2)(const char* path);
+    void (*release_part2)(void* data);
+
+    // writes a valid synthetic input; what `size` counts (lines, rows, vertices, ...) is up to the day
+    bool (*generate)(FILE* out, size_t size, uint64_t seed);
+
+    // only set when the puzzle has parameters that aren't part of the input, which every solver of
+    // the day takes as `-o key=value` options: like a variant's `configure`, false for an option it
+    // doesn't know and configure(NULL) for the defaults, the puzzle's own values
+    bool (*configure)(const char* option);
+    const char* options;
+
+    const AocVariant* variants;
+    size_t n_variants;
+} AocDay;
+
+extern const AocDay day01, day02, day03, day04, day05, day06, day07, day08, day09, day10, day11;
+
+// all days in order, for the multi-day binaries
+#define AOC_N_DAYS 11
+extern const AocDay* const AOC_DAYS[AOC_N_DAYS];
+
+// marks the days named by `arg` ("7", "07", "day07" or a range like "3-5") in `selected`
+bool aoc_select_days(const char* arg, bool* selected);
+
+// the variant called `name`; NULL for the reference and for a name the day has no variant for
+const AocVariant* aoc_find_variant(const AocDay* day, const char* name);
+
+// for a `-o` option of the form `key=N`, true and N in `value`; false for any other option
+bool aoc_option_size(const char* option, const char* key, size_t* value);
+
+// `day` with the parts of its variant `name` swapped in ("reference" gives `day` itself);
+// false if there's no such variant
+bool aoc_day_variant(const AocDay* day, const char* name, AocDay* out);
+
+// command line of the single-day binaries: `dayNN [-p 1|2] [-v variant] [-o key=value] [input|-]`
+int aoc_day_main(const AocDay* day, int argc, char** argv);
+
+// moves a by-value parse result to the heap so it can be passed around as `void*`
+static inline void* aoc_box(const void* value, const size_t size) {
+    void* boxed = malloc(size);
+    if (boxed) {
+        memcpy(boxed, value, size);
+    }
+    return boxed;
+}
+
+static inline unsigned long long aoc_now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long) ts.tv_sec * 1000000000ull + (unsigned long long) ts.tv_nsec;
+}
+
+static inline double aoc_now_ms(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double) ts.tv_sec * 1e3 + (double) ts.tv_nsec / 1e6;
+}
+
+#endif
@@ -0,0 +1,70 @@
+#include "arena.h"
+
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+struct ArenaBlock {
+    ArenaBlock* prev;
+    size_t used, capacity;
+    alignas(max_align_t) unsigned char data[];
+};
+
+static const size_t MIN_BLOCK = 4096;
+
+void arena_init(Arena* arena, const size_t expected) {
+    *arena = (Arena) { .head = NULL, .next_size = expected > MIN_BLOCK ? expected : MIN_BLOCK };
+}
+
+void arena_free(Arena* arena) {
+    for (ArenaBlock* block = arena->head; block; ) {
+        ArenaBlock* prev = block->prev;
+        free(block);
+        block = prev;
+    }
+    arena->head = NULL;
+}
+
+static ArenaBlock* grow(Arena* arena, const size_t size) {
+    size_t capacity = arena->next_size;
+    while (capacity < size) {
+        capacity *= 2;
+    }
+
+    ArenaBlock* block = malloc(sizeof(ArenaBlock) + capacity);
+    if (!block) {
+        return NULL;
+    }
+    *block = (ArenaBlock) { .prev = arena->head, .used = 0, .capacity = capacity };
+    arena->head = block;
+    arena->next_size = capacity * 2;
+    return block;
+}
+
+void* arena_alloc(Arena* arena, const size_t size, const size_t align) {
+    ArenaBlock* block = arena->head;
+    if (block) {
+        const size_t offset = (block->used + align - 1) & ~(align - 1);
+        if (offset <= block->capacity && size <= block->capacity - offset) {
+            block->used = offset + size;
+            return block->data + offset;
+        }
+    }
+
+    // a fresh block starts max_align_t aligned, so any smaller alignment fits at offset 0
+    block = grow(arena, size);
+    if (!block) {
+        return NULL;
+    }
+    block->used = size;
+    return block->data;
+}
+
+char* arena_strndup(Arena* arena, const char* str, const size_t len) {
+    char* copy = arena_alloc(arena, len + 1, 1);
+    if (copy) {
+        memcpy(copy, str, len);
+        copy[len] = '\0';
+    }
+    return copy;
+}
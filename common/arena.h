@@ -0,0 +1,27 @@
+#ifndef AOC_ARENA_H
+#define AOC_ARENA_H
+
+#include <stdalign.h>
+#include <stddef.h>
+
+typedef struct ArenaBlock ArenaBlock;
+
+// Bump allocator for parse results: everything a day parses lives in a few large blocks,
+// allocated back to back so the solvers walk contiguous memory, and is freed with one call.
+// Blocks double in size as the arena grows; nothing is freed individually.
+typedef struct {
+    ArenaBlock* head;
+    size_t next_size;
+} Arena;
+
+// `expected` sizes the first block, 0 picks a small default
+void arena_init(Arena* arena, size_t expected);
+void arena_free(Arena* arena);
+
+// NULL when out of memory; the memory is uninitialised
+void* arena_alloc(Arena* arena, size_t size, size_t align);
+char* arena_strndup(Arena* arena, const char* str, size_t len);
+
+#define ARENA_NEW(arena, type, n) ((type*) arena_alloc((arena), sizeof(type) * (n), alignof(type)))
+
+#endif
@@ -0,0 +1,468 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "aoc.h"
+#include "scan.h"
+
+typedef enum { CSV, JSON } Format;
+
+typedef struct {
+    size_t reps;
+    size_t warmup;
+    double budget_s;
+    Format format;
+    bool part1, part2;
+    bool parse_only;
+    // NULL for the reference only, "all" for the reference and every variant
+    const char* variant;
+    uint64_t seed;
+} Config;
+
+typedef struct {
+    const char* day;
+    const char* variant;
+    size_t size; // 0 for the puzzle input, otherwise the size it was generated with
+    const char* phase;
+    size_t reps;
+    size_t input_bytes;
+    unsigned long long min_ns, median_ns, p99_ns;
+    double mean_ns;
+    bool has_answer;
+    size_t answer;
+} Stats;
+
+typedef struct {
+    const AocDay* day;
+    const char* path;
+    void* data;
+    size_t answer;
+    bool part2;
+} Phase;
+
+static int compareNs(const void* a, const void* b) {
+    const unsigned long long x = *(const unsigned long long*) a;
+    const unsigned long long y = *(const unsigned long long*) b;
+
+    if (x < y) return -1;
+    if (x > y) return 1;
+    return 0;
+}
+
+// one timed call of the phase; parse phases release what they produced outside the timed region
+static bool runParse(Phase* phase, unsigned long long* ns) {
+    void* (*parse)(const char*) = phase->part2 ? phase->day->parse_part2 : phase->day->parse;
+    void (*release)(void*) = phase->part2 ? phase->day->release_part2 : phase->day->release;
+
+    const unsigned long long start = aoc_now_ns();
+    void* data = parse(phase->path);
+    *ns = aoc_now_ns() - start;
+
+    if (!data) {
+        return false;
+    }
+    release(data);
+    return true;
+}
+
+static bool runPart(Phase* phase, unsigned long long* ns) {
+    size_t (*part)(const void*) = phase->part2 ? phase->day->part2 : phase->day->part1;
+
+    const unsigned long long start = aoc_now_ns();
+    phase->answer = part(phase->data);
+    *ns = aoc_now_ns() - start;
+    return true;
+}
+
+static bool measure(const Config* config, Phase* phase, bool (*run)(Phase*, unsigned long long*), Stats* stats) {
+    unsigned long long* samples = malloc(sizeof(unsigned long long) * config->reps);
+    if (!samples) {
+        perror("Out of memory.");
+        return false;
+    }
+
+    unsigned long long ns;
+    for (size_t i = 0; i < config->warmup; i++) {
+        if (!run(phase, &ns)) {
+            goto error;
+        }
+    }
+
+    // always at least one sample, then stop early once the time budget for this phase is used up
+    const double budget_ns = config->budget_s * 1e9;
+    double total_ns = 0;
+    size_t n = 0;
+    while (n < config->reps && (n == 0 || total_ns < budget_ns)) {
+        if (!run(phase, &ns)) {
+            goto error;
+        }
+        samples[n++] = ns;
+        total_ns += (double) ns;
+    }
+
+    qsort(samples, n, sizeof(unsigned long long), compareNs);
+    const size_t p99 = (n * 99 + 99) / 100;
+    stats->reps = n;
+    stats->min_ns = samples[0];
+    stats->median_ns = n % 2 ? samples[n / 2] : (samples[n / 2 - 1] + samples[n / 2]) / 2;
+    stats->p99_ns = samples[p99 > 0 ? p99 - 1 : 0];
+    stats->mean_ns = total_ns / (double) n;
+
+    free(samples);
+    return true;
+error:
+    free(samples);
+    return false;
+}
+
+static double bytesPerSecond(const Stats* stats) {
+    return stats->median_ns ? (double) stats->input_bytes * 1e9 / (double) stats->median_ns : 0.0;
+}
+
+static void printHeader(const Config* config) {
+    if (config->format == CSV) {
+        printf("day,variant,size,phase,reps,input_bytes,min_ns,median_ns,p99_ns,mean_ns,bytes_per_s,answer\n");
+    } else {
+        printf("[");
+    }
+}
+
+static void printStats(const Config* config, const Stats* stats) {
+    static bool first = true;
+
+    if (config->format == CSV) {
+        printf("%s,%s,", stats->day, stats->variant);
+        if (stats->size) {
+            printf("%zu", stats->size);
+        }
+        printf(",%s,%zu,%zu,%llu,%llu,%llu,%.0f,%.0f,", stats->phase, stats->reps, stats->input_bytes,
+            stats->min_ns, stats->median_ns, stats->p99_ns, stats->mean_ns, bytesPerSecond(stats));
+        if (stats->has_answer) {
+            printf("%zu", stats->answer);
+        }
+        printf("\n");
+    } else {
+        printf("%s\n  {\"day\": \"%s\", \"variant\": \"%s\", ", first ? "" : ",", stats->day, stats->variant);
+        if (stats->size) {
+            printf("\"size\": %zu, ", stats->size);
+        }
+        printf("\"phase\": \"%s\", \"reps\": %zu, \"input_bytes\": %zu, "
+            "\"min_ns\": %llu, \"median_ns\": %llu, \"p99_ns\": %llu, \"mean_ns\": %.0f, \"bytes_per_s\": %.0f",
+            stats->phase, stats->reps, stats->input_bytes,
+            stats->min_ns, stats->median_ns, stats->p99_ns, stats->mean_ns, bytesPerSecond(stats));
+        if (stats->has_answer) {
+            printf(", \"answer\": %zu", stats->answer);
+        }
+        printf("}");
+    }
+    first = false;
+    fflush(stdout);
+}
+
+static void printFooter(const Config* config) {
+    if (config->format == JSON) {
+        printf("\n]\n");
+    }
+}
+
+static bool benchPart(const Config* config, const AocDay* day, const char* path, const Stats* input, const bool part2) {
+    Phase phase = { .day = day, .path = path, .part2 = part2 };
+    Stats stats = *input;
+
+    const bool separate_parse = !part2 || day->parse_part2;
+    if (separate_parse) {
+        stats.phase = part2 ? "parse2" : "parse";
+        if (!measure(config, &phase, runParse, &stats)) {
+            goto error;
+        }
+        printStats(config, &stats);
+    }
+    if (config->parse_only) {
+        return true;
+    }
+
+    phase.data = part2 && day->parse_part2 ? day->parse_part2(path) : day->parse(path);
+    if (!phase.data) {
+        goto error;
+    }
+
+    stats.phase = part2 ? "part2" : "part1";
+    const bool ok = measure(config, &phase, runPart, &stats);
+    if (part2 && day->parse_part2) {
+        day->release_part2(phase.data);
+    } else {
+        day->release(phase.data);
+    }
+    if (!ok) {
+        goto error;
+    }
+
+    stats.has_answer = true;
+    stats.answer = phase.answer;
+    printStats(config, &stats);
+    return true;
+error:
+    fprintf(stderr, "%s: unable to parse '%s'\n", day->name, path);
+    return false;
+}
+
+static bool benchSolver(const Config* config, const AocDay* day, const char* variant, const char* path, const size_t size) {
+    struct stat st;
+    if (stat(path, &st) != 0) {
+        fprintf(stderr, "%s: cannot stat '%s'\n", day->name, path);
+        return false;
+    }
+    const Stats input = { .day = day->name, .variant = variant, .size = size, .input_bytes = (size_t) st.st_size };
+
+    // part 2 re-uses part 1's parse timings unless it has its own parser
+    if (config->part1 && !benchPart(config, day, path, &input, false)) {
+        return false;
+    }
+    if (config->part2) {
+        if (!config->part1 && !day->parse_part2) {
+            Phase phase = { .day = day, .path = path };
+            Stats stats = input;
+            stats.phase = "parse";
+            if (!measure(config, &phase, runParse, &stats)) {
+                return false;
+            }
+            printStats(config, &stats);
+        }
+        if (!benchPart(config, day, path, &input, true)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// the reference and/or the variants picked with -v, all on the same input
+static bool benchDay(const Config* config, const AocDay* day, const char* path, const size_t size) {
+    const bool all = config->variant && strcmp(config->variant, "all") == 0;
+    bool ok = true;
+    if (!config->variant || all || strcmp(config->variant, "reference") == 0) {
+        ok = benchSolver(config, day, "reference", path, size) && ok;
+    }
+
+    for (size_t v = 0; v < day->n_variants; v++) {
+        const char* name = day->variants[v].name;
+        if (all || (config->variant && strcmp(config->variant, name) == 0)) {
+            AocDay solver;
+            aoc_day_variant(day, name, &solver);
+            ok = benchSolver(config, &solver, name, path, size) && ok;
+        }
+    }
+    return ok;
+}
+
+// generates an input of the given size into a temporary file and benchmarks the day on it
+static bool benchGenerated(const Config* config, const AocDay* day, const size_t size) {
+    const char* tmpdir = getenv("TMPDIR");
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/aoc_%s_XXXXXX", tmpdir && *tmpdir ? tmpdir : "/tmp", day->name);
+
+    const int fd = mkstemp(path);
+    FILE* out = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!out) {
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+            unlink(path);
+        }
+        return false;
+    }
+
+    const bool generated = day->generate(out, size, config->seed);
+    if (fclose(out) != 0 || !generated) {
+        fprintf(stderr, "%s: failed to generate input of size %zu\n", day->name, size);
+        unlink(path);
+        return false;
+    }
+
+    const bool ok = benchDay(config, day, path, size);
+    unlink(path);
+    return ok;
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [-n reps] [-w warmup] [-t seconds] [-f csv|json] [-p 1|2|parse] [-v variant|all] [-x scalar|sse42|avx2] [-o key=value] [-d input_dir | -i input | -g sizes [-s seed]] [day|from-to ...]\n"
+        "  times every phase (parse, part1, part2; parse2 where part 2 has its own parser) of the selected days\n"
+        "  -n  timed repetitions per phase (default 20)\n"
+        "  -w  untimed warm-up repetitions per phase (default 2)\n"
+        "  -t  stop repeating a phase once it has used this many seconds (default 5)\n"
+        "  -p  only time part 1, part 2 or just the parsers\n"
+        "  -v  time this solver variant instead of the reference, or the reference and every variant\n"
+        "  -x  byte scanner the parsers use (default: the widest this CPU supports)\n"
+        "  -o  puzzle parameter of the selected days or option for the timed variants that take it,\n"
+        "      see `dayNN -h`; may be repeated\n"
+        "  -i  benchmark a single selected day on this input instead of <input_dir>/dayNN.txt\n"
+        "  -g  benchmark on generated inputs of these comma separated sizes instead, e.g. -g 1000,10000,100000\n"
+        "  -s  seed for -g (default 2025)\n",
+        argv0);
+}
+
+int main(int argc, char** argv) {
+    Config config = { .reps = 20, .warmup = 2, .budget_s = 5.0, .format = CSV, .part1 = true, .part2 = true, .seed = 2025 };
+    const char* input_dir = "inputs";
+    const char* input = NULL;
+    size_t sizes[64];
+    size_t n_sizes = 0;
+    bool selected[AOC_N_DAYS] = { false };
+    size_t n_selected = 0;
+    const char* options[16];
+    size_t n_options = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-n") == 0 && i + 1 < argc) {
+            const long n = strtol(argv[++i], NULL, 10);
+            config.reps = n > 0 ? (size_t) n : 1;
+        } else if (strcmp(arg, "-w") == 0 && i + 1 < argc) {
+            const long n = strtol(argv[++i], NULL, 10);
+            config.warmup = n > 0 ? (size_t) n : 0;
+        } else if (strcmp(arg, "-t") == 0 && i + 1 < argc) {
+            config.budget_s = strtod(argv[++i], NULL);
+        } else if (strcmp(arg, "-f") == 0 && i + 1 < argc) {
+            const char* format = argv[++i];
+            if (strcmp(format, "csv") == 0) {
+                config.format = CSV;
+            } else if (strcmp(format, "json") == 0) {
+                config.format = JSON;
+            } else {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(arg, "-p") == 0 && i + 1 < argc) {
+            const char* part = argv[++i];
+            config.part1 = strcmp(part, "1") == 0;
+            config.part2 = strcmp(part, "2") == 0;
+            if (strcmp(part, "parse") == 0) {
+                config.part1 = config.part2 = config.parse_only = true;
+            }
+            if (!config.part1 && !config.part2) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(arg, "-d") == 0 && i + 1 < argc) {
+            input_dir = argv[++i];
+        } else if (strcmp(arg, "-i") == 0 && i + 1 < argc) {
+            input = argv[++i];
+        } else if (strcmp(arg, "-g") == 0 && i + 1 < argc) {
+            for (char* size = argv[++i]; *size && n_sizes < sizeof(sizes) / sizeof(sizes[0]); ) {
+                sizes[n_sizes++] = (size_t) strtoull(size, &size, 10);
+                if (*size == ',') {
+                    size++;
+                }
+            }
+        } else if (strcmp(arg, "-v") == 0 && i + 1 < argc) {
+            config.variant = argv[++i];
+        } else if (strcmp(arg, "-x") == 0 && i + 1 < argc) {
+            ScanIsa isa;
+            if (!scan_isa_parse(argv[++i], &isa) || !scan_use(isa)) {
+                fprintf(stderr, "scanner '%s' isn't available on this CPU\n", argv[i]);
+                return 1;
+            }
+        } else if (strcmp(arg, "-o") == 0 && i + 1 < argc && n_options < sizeof(options) / sizeof(*options)) {
+            options[n_options++] = argv[++i];
+        } else if (strcmp(arg, "-s") == 0 && i + 1 < argc) {
+            config.seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else if (aoc_select_days(arg, selected)) {
+            n_selected = 0;
+            for (size_t d = 0; d < AOC_N_DAYS; d++) {
+                n_selected += selected[d];
+            }
+        } else {
+            fprintf(stderr, "invalid argument '%s'\n", arg);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (input && n_selected != 1) {
+        fprintf(stderr, "-i needs exactly one day\n");
+        return 1;
+    }
+
+    // a variant only some of the selected days have times just those, one that none has is an error
+    if (config.variant && strcmp(config.variant, "all") != 0) {
+        size_t n_found = 0;
+        for (size_t d = 0; d < AOC_N_DAYS; d++) {
+            if (n_selected && !selected[d]) {
+                continue;
+            }
+            AocDay solver;
+            if (aoc_day_variant(AOC_DAYS[d], config.variant, &solver)) {
+                n_found++;
+            } else if (n_selected) {
+                fprintf(stderr, "%s has no variant '%s', skipping it\n", AOC_DAYS[d]->name, config.variant);
+            }
+        }
+        if (!n_found) {
+            fprintf(stderr, "no selected day has a variant '%s'\n", config.variant);
+            return 1;
+        }
+    }
+
+    // options are puzzle parameters of the day or go to the timed variants that take them; every
+    // option must be taken on each selected day that has them
+    const bool all = config.variant && strcmp(config.variant, "all") == 0;
+    for (size_t d = 0; d < AOC_N_DAYS && n_options; d++) {
+        const AocDay* day = AOC_DAYS[d];
+        AocDay solver;
+        if ((n_selected && !selected[d]) || (config.variant && !all && !aoc_day_variant(day, config.variant, &solver))) {
+            continue;
+        }
+        for (size_t o = 0; o < n_options; o++) {
+            bool taken = day->configure && day->configure(options[o]);
+            for (size_t v = 0; v < day->n_variants; v++) {
+                const AocVariant* variant = &day->variants[v];
+                if ((all || (config.variant && strcmp(config.variant, variant->name) == 0)) && variant->configure) {
+                    taken = variant->configure(options[o]) || taken;
+                }
+            }
+            if (!taken) {
+                fprintf(stderr, "%s %s has no option '%s'\n", day->name, config.variant ? config.variant : "reference", options[o]);
+                return 1;
+            }
+        }
+    }
+
+    int status = 0;
+    printHeader(&config);
+    for (size_t d = 0; d < AOC_N_DAYS; d++) {
+        if (n_selected && !selected[d]) {
+            continue;
+        }
+
+        const AocDay* day = AOC_DAYS[d];
+        if (n_sizes) {
+            for (size_t i = 0; i < n_sizes; i++) {
+                if (!benchGenerated(&config, day, sizes[i])) {
+                    status = 1;
+                }
+            }
+            continue;
+        }
+
+        char path[4096];
+        if (input) {
+            snprintf(path, sizeof(path), "%s", input);
+        } else {
+            snprintf(path, sizeof(path), "%s/%s.txt", input_dir, day->name);
+        }
+
+        if (!benchDay(&config, day, path, 0)) {
+            status = 1;
+        }
+    }
+    printFooter(&config);
+
+    return status;
+}
@@ -0,0 +1,223 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aoc.h"
+#include "memstat.h"
+#include "perf.h"
+
+const AocVariant* aoc_find_variant(const AocDay* day, const char* name) {
+    for (size_t i = 0; i < day->n_variants; i++) {
+        if (strcmp(day->variants[i].name, name) == 0) {
+            return &day->variants[i];
+        }
+    }
+    return NULL;
+}
+
+bool aoc_option_size(const char* option, const char* key, size_t* value) {
+    const size_t key_len = strlen(key);
+    if (strncmp(option, key, key_len) != 0 || option[key_len] != '=') {
+        return false;
+    }
+
+    const char* digits = option + key_len + 1;
+    char* end;
+    const unsigned long long n = strtoull(digits, &end, 10);
+    if (*digits < '0' || *digits > '9' || *end) {
+        return false;
+    }
+    *value = (size_t) n;
+    return true;
+}
+
+bool aoc_day_variant(const AocDay* day, const char* name, AocDay* out) {
+    *out = *day;
+    if (strcmp(name, "reference") == 0) {
+        return true;
+    }
+
+    const AocVariant* variant = aoc_find_variant(day, name);
+    if (variant) {
+        if (variant->parse) {
+            out->parse = variant->parse;
+            out->release = variant->release;
+            out->parse_part2 = NULL;
+            out->release_part2 = NULL;
+        }
+        if (variant->part1) {
+            out->part1 = variant->part1;
+        }
+        if (variant->part2) {
+            out->part2 = variant->part2;
+        }
+    }
+    return variant != NULL;
+}
+
+static void usage(const char* argv0, const AocDay* day) {
+    fprintf(stderr,
+        "usage: %s [-p 1|2] [-v variant] [-o key=value] [input]\n"
+        "  solves %s for `input` (default inputs/%s.txt); `-` reads the input from stdin\n"
+        "  -p  only run part 1 or part 2\n"
+        "  -v  solver to use: reference (default)",
+        argv0, day->name, day->name);
+    for (size_t i = 0; i < day->n_variants; i++) {
+        fprintf(stderr, ", %s", day->variants[i].name);
+    }
+    fprintf(stderr, "\n");
+    if (day->options) {
+        fprintf(stderr, "  -o  %s\n", day->options);
+    }
+    for (size_t i = 0; i < day->n_variants; i++) {
+        if (day->variants[i].options) {
+            fprintf(stderr, "  -o  for %s: %s\n", day->variants[i].name, day->variants[i].options);
+        }
+    }
+}
+
+int aoc_day_main(const AocDay* day, const int argc, char** argv) {
+    bool part1 = true, part2 = true;
+    const char* path = NULL;
+    const char* variant = "reference";
+    const char* options[16];
+    size_t n_options = 0;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-p") == 0 && i + 1 < argc) {
+            const char* part = argv[++i];
+            part1 = strcmp(part, "1") == 0;
+            part2 = strcmp(part, "2") == 0;
+            if (!part1 && !part2) {
+                usage(argv[0], day);
+                return 1;
+            }
+        } else if (strcmp(arg, "-v") == 0 && i + 1 < argc) {
+            variant = argv[++i];
+        } else if (strcmp(arg, "-o") == 0 && i + 1 < argc && n_options < sizeof(options) / sizeof(*options)) {
+            options[n_options++] = argv[++i];
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage(argv[0], day);
+            return 0;
+        } else if (!path && (arg[0] != '-' || strcmp(arg, "-") == 0)) {
+            path = arg;
+        } else {
+            fprintf(stderr, "invalid argument '%s'\n", arg);
+            usage(argv[0], day);
+            return 1;
+        }
+    }
+
+    AocDay solver;
+    if (!aoc_day_variant(day, variant, &solver)) {
+        fprintf(stderr, "%s has no variant '%s'\n", day->name, variant);
+        usage(argv[0], day);
+        return 1;
+    }
+
+    // options are the day's puzzle parameters or belong to the chosen solver, whichever order -v and -o came in
+    const AocVariant* configurable = aoc_find_variant(day, variant);
+    for (size_t i = 0; i < n_options; i++) {
+        if (day->configure && day->configure(options[i])) {
+            continue;
+        }
+        if (!configurable || !configurable->configure || !configurable->configure(options[i])) {
+            fprintf(stderr, "%s %s has no option '%s'\n", day->name, variant, options[i]);
+            usage(argv[0], day);
+            return 1;
+        }
+    }
+    day = &solver;
+
+    char default_path[64];
+    if (!path) {
+        snprintf(default_path, sizeof(default_path), "inputs/%s.txt", day->name);
+        path = default_path;
+    }
+
+    // phases in the order they ran, for the counter table
+    const char* phases[4];
+    PerfSample samples[4];
+    MemSample mem[4];
+    size_t n_phases = 0;
+    (void) phases;
+    (void) samples;
+    (void) mem;
+
+    // a day with a dedicated part 2 parser doesn't need the shared parse for part 2 alone
+    void* data = NULL;
+    if (part1 || !day->parse_part2) {
+        MEMSTAT_BEGIN(parse_mark);
+        PERF_BEGIN(parse_counters);
+        data = day->parse(path);
+        PERF_END(parse_counters, &samples[n_phases]);
+        MEMSTAT_END(parse_mark, &mem[n_phases]);
+        phases[n_phases++] = "parse";
+        if (!data) {
+            fprintf(stderr, "Unable to parse '%s'\n", path);
+            return 1;
+        }
+    }
+
+    if (part1) {
+        MEMSTAT_BEGIN(part1_mark);
+        PERF_BEGIN(part1_counters);
+        const size_t p1 = day->part1(data);
+        PERF_END(part1_counters, &samples[n_phases]);
+        MEMSTAT_END(part1_mark, &mem[n_phases]);
+        phases[n_phases++] = "part1";
+        printf("Part 1: %zu\n", p1);
+    }
+
+    int status = 0;
+    if (part2) {
+        void* data2 = data;
+        if (day->parse_part2) {
+            MEMSTAT_BEGIN(parse2_mark);
+            PERF_BEGIN(parse2_counters);
+            data2 = day->parse_part2(path);
+            PERF_END(parse2_counters, &samples[n_phases]);
+            MEMSTAT_END(parse2_mark, &mem[n_phases]);
+            phases[n_phases++] = "parse2";
+        }
+
+        if (data2) {
+            MEMSTAT_BEGIN(part2_mark);
+            PERF_BEGIN(part2_counters);
+            const size_t p2 = day->part2(data2);
+            PERF_END(part2_counters, &samples[n_phases]);
+            MEMSTAT_END(part2_mark, &mem[n_phases]);
+            phases[n_phases++] = "part2";
+            printf("Part 2: %zu\n", p2);
+        } else {
+            fprintf(stderr, "Unable to parse '%s'\n", path);
+            status = 1;
+        }
+
+        if (data2 && day->parse_part2) {
+            day->release_part2(data2);
+        }
+    }
+
+    if (data) {
+        day->release(data);
+    }
+
+#ifdef AOC_PERF
+    printf("\n");
+    perf_print_header(stdout);
+    for (size_t i = 0; i < n_phases; i++) {
+        perf_print_row(stdout, day->name, phases[i], &samples[i]);
+    }
+#endif
+#ifdef AOC_MEMSTAT
+    printf("\n");
+    memstat_print_header(stdout);
+    for (size_t i = 0; i < n_phases; i++) {
+        memstat_print_row(stdout, day->name, phases[i], &mem[i]);
+    }
+#endif
+    return status;
+}
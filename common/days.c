@@ -0,0 +1,28 @@
+#include <stdlib.h>
+
+#include "aoc.h"
+
+const AocDay* const AOC_DAYS[AOC_N_DAYS] = {
+    &day01, &day02, &day03, &day04, &day05, &day06, &day07, &day08, &day09, &day10, &day11,
+};
+
+bool aoc_select_days(const char* arg, bool* selected) {
+    if (strncmp(arg, "day", 3) == 0) {
+        arg += 3;
+    }
+
+    char* end;
+    const long from = strtol(arg, &end, 10);
+    long to = from;
+    if (*end == '-') {
+        to = strtol(end + 1, &end, 10);
+    }
+    if (end == arg || *end != '\0' || from < 1 || to < from || (size_t) to > AOC_N_DAYS) {
+        return false;
+    }
+
+    for (long d = from; d <= to; d++) {
+        selected[d - 1] = true;
+    }
+    return true;
+}
@@ -0,0 +1,48 @@
+#include "digits.h"
+
+// offers `digit` to every selection, with `remaining` digits of the string still to come after it
+static void selectDigit(DigitSelection* selections, const size_t n_selections, const unsigned char digit, const size_t remaining) {
+    for (size_t s = 0; s < n_selections; s++) {
+        DigitSelection* selection = &selections[s];
+        while (selection->len && selection->digits[selection->len - 1] < digit && selection->len + remaining >= selection->k) {
+            selection->len--;
+        }
+        if (selection->len < selection->k) {
+            selection->digits[selection->len++] = digit;
+        }
+    }
+}
+
+void digits_select_many(const unsigned char* digits, const size_t n, DigitSelection* selections, const size_t n_selections) {
+    for (size_t s = 0; s < n_selections; s++) {
+        selections[s].len = 0;
+    }
+    for (size_t i = 0; i < n; i++) {
+        selectDigit(selections, n_selections, digits[i], n - i - 1);
+    }
+}
+
+size_t digits_select(const unsigned char* digits, const size_t n, const size_t k, unsigned char* out) {
+    if (n < k) {
+        return 0;
+    }
+
+    DigitSelection selection = { out, k, 0 };
+    digits_select_many(digits, n, &selection, 1);
+    return selection.len;
+}
+
+bool digits_value(const DigitSelection* selection, size_t* value) {
+    if (selection->len < selection->k) {
+        return false;
+    }
+
+    size_t number = 0;
+    for (size_t i = 0; i < selection->len; i++) {
+        if (__builtin_mul_overflow(number, 10, &number) || __builtin_add_overflow(number, selection->digits[i], &number)) {
+            return false;
+        }
+    }
+    *value = number;
+    return true;
+}
@@ -0,0 +1,28 @@
+#ifndef AOC_DIGITS_H
+#define AOC_DIGITS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Best-k digit selection: the lexicographically largest subsequence of exactly k digits of a
+// digit string, which among k-digit subsequences is also the largest number. A monotonic stack
+// drops smaller digits whenever a larger one arrives and enough digits remain to still fill all
+// k places, so every digit is pushed and popped at most once: O(n) for any k.
+typedef struct {
+    // room for k digits; the first `len` are the selection, fewer than k only for a string shorter than k
+    unsigned char* digits;
+    size_t k, len;
+} DigitSelection;
+
+// selects the best `k` of the `n` digits (values 0-9) into `out`, which has room for k; returns
+// how many were selected, k or, for fewer than k digits, 0
+size_t digits_select(const unsigned char* digits, size_t n, size_t k, unsigned char* out);
+
+// digits_select for several selections with their own k at once, in a single pass over the digits
+void digits_select_many(const unsigned char* digits, size_t n, DigitSelection* selections, size_t n_selections);
+
+// the selected digits as a number; false if there are fewer than k of them or the number doesn't
+// fit a size_t, which any k up to 19 does
+bool digits_value(const DigitSelection* selection, size_t* value);
+
+#endif
@@ -0,0 +1,73 @@
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aoc.h"
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [-o output] day size [seed]\n"
+        "  writes a synthetic input for `day` in the puzzle's format to stdout (or `output`);\n"
+        "  `size` counts the day's natural unit (rotations, ranges, rows, boxes, vertices, devices, ...)\n",
+        argv0);
+}
+
+int main(int argc, char** argv) {
+    const char* output = NULL;
+    const char* positional[3] = { NULL, NULL, NULL };
+    size_t n_positional = 0;
+
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "-o") == 0 && i + 1 < argc) {
+            output = argv[++i];
+        } else if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else if (n_positional < 3) {
+            positional[n_positional++] = argv[i];
+        } else {
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    bool selected[AOC_N_DAYS] = { false };
+    if (n_positional < 2 || !aoc_select_days(positional[0], selected)) {
+        usage(argv[0]);
+        return 1;
+    }
+
+    const AocDay* day = NULL;
+    for (size_t d = 0; d < AOC_N_DAYS; d++) {
+        if (selected[d]) {
+            if (day) {
+                fprintf(stderr, "can only generate one day at a time\n");
+                return 1;
+            }
+            day = AOC_DAYS[d];
+        }
+    }
+
+    const size_t size = (size_t) strtoull(positional[1], NULL, 10);
+    const uint64_t seed = n_positional > 2 ? strtoull(positional[2], NULL, 10) : 2025;
+
+    FILE* out = output ? fopen(output, "w") : stdout;
+    if (!out) {
+        perror(output);
+        return 1;
+    }
+
+    int status = 0;
+    if (!day->generate(out, size, seed)) {
+        fprintf(stderr, "%s: failed to generate input\n", day->name);
+        status = 1;
+    }
+
+    if (out != stdout && fclose(out) != 0) {
+        perror(output);
+        status = 1;
+    }
+    return status;
+}
@@ -0,0 +1,259 @@
+#define _GNU_SOURCE // memrchr
+
+#include "input.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "scan.h"
+
+// reads everything from `fd` into a growing buffer, for anything that can't be mapped
+static bool readAll(Input* input, const int fd, size_t capacity) {
+    if (capacity < 4096) {
+        capacity = 4096;
+    }
+
+    char* buffer = malloc(capacity + 1);
+    if (!buffer) {
+        perror("Out of memory.");
+        return false;
+    }
+
+    size_t size = 0;
+    for (;;) {
+        if (size == capacity) {
+            char* new = realloc(buffer, capacity * 2 + 1);
+            if (!new) {
+                perror("Out of memory.");
+                free(buffer);
+                return false;
+            }
+            buffer = new;
+            capacity *= 2;
+        }
+
+        const ssize_t n = read(fd, buffer + size, capacity - size);
+        if (n < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            perror("read");
+            free(buffer);
+            return false;
+        }
+        if (n == 0) {
+            break;
+        }
+        size += (size_t) n;
+    }
+
+    buffer[size] = '\0';
+    *input = (Input) { .data = buffer, .size = size, .mapped = false };
+    return true;
+}
+
+// stdin can only be consumed once, so it is read up front and then kept for the rest of the process;
+// every `input_open("-")` gets the same buffer (day06 parses its input twice)
+static pthread_mutex_t stdin_lock = PTHREAD_MUTEX_INITIALIZER;
+static Input stdin_input;
+static bool stdin_read = false;
+
+static bool openStdin(Input* input) {
+    pthread_mutex_lock(&stdin_lock);
+    if (!stdin_read) {
+        stdin_read = readAll(&stdin_input, STDIN_FILENO, 0);
+    }
+    const bool ok = stdin_read;
+    pthread_mutex_unlock(&stdin_lock);
+
+    if (ok) {
+        *input = stdin_input;
+    }
+    return ok;
+}
+
+bool input_open(Input* input, const char* path) {
+    if (strcmp(path, "-") == 0) {
+        return openStdin(input);
+    }
+
+    const int fd = open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0) {
+        fprintf(stderr, "failed to stat %s: %s\n", path, strerror(errno));
+        close(fd);
+        return false;
+    }
+
+    // the rest of the last mapped page reads as zeros, which gives us the '\0' sentinel for free;
+    // files ending exactly on a page boundary (and pipes, empty files, ...) are read instead
+    const size_t size = (size_t) st.st_size;
+    const long page = sysconf(_SC_PAGESIZE);
+    if (S_ISREG(st.st_mode) && size > 0 && page > 0 && size % (size_t) page != 0) {
+        void* data = mmap(NULL, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (data != MAP_FAILED) {
+            madvise(data, size, MADV_SEQUENTIAL);
+            close(fd);
+            *input = (Input) { .data = data, .size = size, .mapped = true };
+            return true;
+        }
+    }
+
+    const bool ok = readAll(input, fd, S_ISREG(st.st_mode) ? size : 0);
+    close(fd);
+    return ok;
+}
+
+void input_close(Input* input) {
+    if (input->mapped) {
+        munmap((void*) input->data, input->size);
+    } else {
+        pthread_mutex_lock(&stdin_lock);
+        const bool is_stdin = stdin_read && input->data == stdin_input.data;
+        pthread_mutex_unlock(&stdin_lock);
+        if (!is_stdin) {
+            free((void*) input->data);
+        }
+    }
+    *input = (Input) { .data = NULL, .size = 0, .mapped = false };
+}
+
+size_t input_count_char(const char* start, const size_t len, const char c) {
+    return scan_count(start, start + len, c);
+}
+
+size_t input_count_lines(const Input* input) {
+    const size_t newlines = input_count_char(input->data, input->size, '\n');
+    const bool unterminated = input->size > 0 && input->data[input->size - 1] != '\n';
+    return newlines + unterminated;
+}
+
+bool input_next_line(const Input* input, size_t* pos, Line* line) {
+    if (*pos >= input->size) {
+        return false;
+    }
+
+    const char* start = input->data + *pos;
+    const char* end = input->data + input->size;
+    const char* newline = scan_find(start, end, '\n');
+    const size_t len = (size_t) (newline - start);
+
+    *line = (Line) { .str = start, .len = len };
+    *pos += len + (newline != end);
+    return true;
+}
+
+bool input_lines(const Input* input, Line** lines, size_t* n_lines) {
+    const size_t n = input_count_lines(input);
+    Line* index = malloc(sizeof(Line) * (n ? n : 1));
+    if (!index) {
+        perror("Out of memory.");
+        return false;
+    }
+
+    size_t pos = 0, i = 0;
+    while (input_next_line(input, &pos, &index[i])) {
+        i++;
+    }
+
+    *lines = index;
+    *n_lines = n;
+    return true;
+}
+
+bool stream_open(InputStream* stream, const char* path, const size_t buffer_size) {
+    const int fd = strcmp(path, "-") == 0 ? STDIN_FILENO : open(path, O_RDONLY);
+    if (fd < 0) {
+        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+        return false;
+    }
+    posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+    const size_t capacity = buffer_size ? buffer_size : 1;
+    char* buffer = malloc(capacity + 1);
+    if (!buffer) {
+        perror("Out of memory.");
+        if (fd != STDIN_FILENO) {
+            close(fd);
+        }
+        return false;
+    }
+
+    buffer[0] = '\0';
+    *stream = (InputStream) {
+        .fd = fd, .buffer = buffer, .capacity = capacity, .filled = 0, .consumed = 0, .saved = '\0', .eof = false, .failed = false,
+    };
+    return true;
+}
+
+void stream_close(InputStream* stream) {
+    if (stream->fd != STDIN_FILENO) {
+        close(stream->fd);
+    }
+    free(stream->buffer);
+    stream->buffer = NULL;
+}
+
+bool stream_next(InputStream* stream, Line* chunk) {
+    // put back the byte the last chunk's '\0' covered, then keep its unfinished line
+    stream->buffer[stream->consumed] = stream->saved;
+    const size_t rest = stream->filled - stream->consumed;
+    memmove(stream->buffer, stream->buffer + stream->consumed, rest);
+    stream->filled = rest;
+    stream->consumed = 0;
+
+    const char* last;
+    for (;;) {
+        while (!stream->eof && stream->filled < stream->capacity) {
+            const ssize_t n = read(stream->fd, stream->buffer + stream->filled, stream->capacity - stream->filled);
+            if (n < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                perror("read");
+                stream->failed = true;
+                return false;
+            }
+            stream->eof = n == 0;
+            stream->filled += (size_t) n;
+        }
+
+        last = memrchr(stream->buffer, '\n', stream->filled);
+        if (last || stream->eof) {
+            break;
+        }
+
+        // a single line longer than the whole buffer
+        char* grown = realloc(stream->buffer, stream->capacity * 2 + 1);
+        if (!grown) {
+            perror("Out of memory.");
+            stream->failed = true;
+            return false;
+        }
+        stream->buffer = grown;
+        stream->capacity *= 2;
+    }
+
+    const size_t len = last ? (size_t) (last - stream->buffer) + 1 : stream->filled;
+    if (!len) {
+        return false;
+    }
+
+    stream->consumed = len;
+    stream->saved = stream->buffer[len];
+    stream->buffer[len] = '\0';
+    *chunk = (Line) { .str = stream->buffer, .len = len };
+    return true;
+}
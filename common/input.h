@@ -0,0 +1,56 @@
+#ifndef AOC_INPUT_H
+#define AOC_INPUT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// A whole input file in memory, mapped when possible and read otherwise (pipes, "-" for stdin,
+// which is read incrementally into a growing buffer and never seeked).
+// `data[size]` is always readable and '\0', so parsers may scan one byte past the last line.
+typedef struct {
+    const char* data;
+    size_t size;
+    bool mapped;
+} Input;
+
+// one line of an `Input`, without its '\n'
+typedef struct {
+    const char* str;
+    size_t len;
+} Line;
+
+bool input_open(Input* input, const char* path);
+void input_close(Input* input);
+
+// number of lines, including a last one that isn't terminated by '\n'
+size_t input_count_lines(const Input* input);
+
+// occurrences of `c` in [start, start + len)
+size_t input_count_char(const char* start, size_t len, char c);
+
+// iterates the lines starting at byte offset `*pos`; false once the input is exhausted
+bool input_next_line(const Input* input, size_t* pos, Line* line);
+
+// index of every line, allocated exactly once; free `*lines` when done
+bool input_lines(const Input* input, Line** lines, size_t* n_lines);
+
+// Reads a file (or stdin for "-") in pieces of whole lines through one fixed buffer, for parsers
+// that fold over their input in O(1) memory. The buffer starts at `buffer_size` bytes (at least
+// one) and only grows for a line longer than itself.
+typedef struct {
+    int fd;
+    char* buffer;
+    size_t capacity;
+    size_t filled, consumed;
+    char saved;
+    bool eof, failed;
+} InputStream;
+
+bool stream_open(InputStream* stream, const char* path, size_t buffer_size);
+void stream_close(InputStream* stream);
+
+// the next run of complete lines (the last may lack its '\n'), followed by a readable '\0';
+// valid until the next call; false at the end of the input or on an error (then `stream->failed`)
+bool stream_next(InputStream* stream, Line* chunk);
+
+#endif
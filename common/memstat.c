@@ -0,0 +1,160 @@
+#include "memstat.h"
+
+#include <stdio.h>
+
+#ifdef AOC_MEMSTAT
+
+#include <errno.h>
+#include <fcntl.h>
+#include <malloc.h>
+#include <stdatomic.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+// glibc's own allocator, still reachable under these names after we take over `malloc`
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t n, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+extern void* __libc_memalign(size_t alignment, size_t size);
+extern void __libc_free(void* ptr);
+
+static atomic_size_t allocs = 0, bytes = 0, live = 0, peak = 0;
+
+// `bytes` counts what was asked for; live and peak heap go by the usable size of each block,
+// which is all `free` can know about it
+static void recordAlloc(void* ptr, const size_t requested) {
+    if (!ptr) {
+        return;
+    }
+
+    const size_t size = malloc_usable_size(ptr);
+    atomic_fetch_add_explicit(&allocs, 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&bytes, requested, memory_order_relaxed);
+
+    const size_t now = atomic_fetch_add_explicit(&live, size, memory_order_relaxed) + size;
+    size_t seen = atomic_load_explicit(&peak, memory_order_relaxed);
+    while (now > seen && !atomic_compare_exchange_weak_explicit(&peak, &seen, now, memory_order_relaxed, memory_order_relaxed)) {
+    }
+}
+
+static void recordFree(void* ptr) {
+    if (ptr) {
+        atomic_fetch_sub_explicit(&live, malloc_usable_size(ptr), memory_order_relaxed);
+    }
+}
+
+void* malloc(size_t size) {
+    void* ptr = __libc_malloc(size);
+    recordAlloc(ptr, size);
+    return ptr;
+}
+
+void* calloc(size_t n, size_t size) {
+    void* ptr = __libc_calloc(n, size);
+    recordAlloc(ptr, n * size);
+    return ptr;
+}
+
+void* realloc(void* ptr, size_t size) {
+    const size_t old = ptr ? malloc_usable_size(ptr) : 0;
+    void* new = __libc_realloc(ptr, size);
+    if (new || size == 0) {
+        atomic_fetch_sub_explicit(&live, old, memory_order_relaxed);
+        recordAlloc(new, size);
+    }
+    return new;
+}
+
+void* aligned_alloc(size_t alignment, size_t size) {
+    void* ptr = __libc_memalign(alignment, size);
+    recordAlloc(ptr, size);
+    return ptr;
+}
+
+int posix_memalign(void** out, size_t alignment, size_t size) {
+    if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0) {
+        return EINVAL;
+    }
+    void* ptr = __libc_memalign(alignment, size);
+    if (!ptr) {
+        return ENOMEM;
+    }
+    recordAlloc(ptr, size);
+    *out = ptr;
+    return 0;
+}
+
+void free(void* ptr) {
+    recordFree(ptr);
+    __libc_free(ptr);
+}
+
+// writing 5 to clear_refs resets VmHWM to the current RSS
+static bool resetPeakRss(void) {
+    const int fd = open("/proc/self/clear_refs", O_WRONLY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool ok = write(fd, "5", 1) == 1;
+    close(fd);
+    return ok;
+}
+
+static size_t peakRss(void) {
+    FILE* status = fopen("/proc/self/status", "r");
+    if (!status) {
+        return 0;
+    }
+
+    char line[256];
+    size_t kb = 0;
+    while (fgets(line, sizeof(line), status)) {
+        if (strncmp(line, "VmHWM:", 6) == 0) {
+            kb = (size_t) strtoull(line + 6, NULL, 10);
+            break;
+        }
+    }
+    fclose(status);
+    return kb * 1024;
+}
+
+static bool rss_resettable = false;
+
+void memstat_begin(MemMark* mark) {
+    rss_resettable = resetPeakRss();
+    mark->allocs = atomic_load(&allocs);
+    mark->bytes = atomic_load(&bytes);
+    mark->live = atomic_load(&live);
+    atomic_store(&peak, mark->live);
+}
+
+void memstat_end(const MemMark* mark, MemSample* sample) {
+    // read everything before peakRss(), whose stdio allocates
+    const size_t n_allocs = atomic_load(&allocs) - mark->allocs;
+    const size_t n_bytes = atomic_load(&bytes) - mark->bytes;
+    const size_t high = atomic_load(&peak);
+
+    *sample = (MemSample) {
+        .allocs = n_allocs,
+        .bytes = n_bytes,
+        .peak_heap = high > mark->live ? high - mark->live : 0,
+        .peak_rss = rss_resettable ? peakRss() : 0,
+        .has_rss = rss_resettable,
+    };
+}
+
+#endif
+
+void memstat_print_header(FILE* out) {
+    fprintf(out, "%-6s %-7s %12s %16s %16s %16s\n", "day", "phase", "allocs", "bytes", "peak-heap", "peak-rss");
+}
+
+void memstat_print_row(FILE* out, const char* day, const char* phase, const MemSample* sample) {
+    fprintf(out, "%-6s %-7s %12zu %16zu %16zu", day, phase, sample->allocs, sample->bytes, sample->peak_heap);
+    if (sample->has_rss) {
+        fprintf(out, " %16zu\n", sample->peak_rss);
+    } else {
+        fprintf(out, " %16s\n", "-");
+    }
+}
@@ -0,0 +1,46 @@
+#ifndef AOC_MEMSTAT_H
+#define AOC_MEMSTAT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdio.h>
+
+// Heap accounting around a phase: allocation count, bytes requested through malloc & co.,
+// the high-water mark of live heap bytes and the peak resident set. Only compiled in with
+// -DAOC_MEMSTAT=ON, which replaces the allocator entry points process-wide; otherwise
+// MEMSTAT_BEGIN/MEMSTAT_END expand to nothing. The counters are process-wide, so phases
+// must not overlap (the runner goes sequential in this mode).
+typedef struct {
+    size_t allocs;
+    size_t bytes;
+    size_t peak_heap;
+    size_t peak_rss;
+    bool has_rss;
+} MemSample;
+
+#ifdef AOC_MEMSTAT
+
+typedef struct {
+    size_t allocs, bytes, live;
+} MemMark;
+
+void memstat_begin(MemMark* mark);
+void memstat_end(const MemMark* mark, MemSample* sample);
+
+#define MEMSTAT_BEGIN(name) MemMark name; memstat_begin(&name)
+#define MEMSTAT_END(name, sample) memstat_end(&name, (sample))
+
+#else
+
+#define MEMSTAT_BEGIN(name) ((void) 0)
+#define MEMSTAT_END(name, sample) ((void) 0)
+
+#endif
+
+// bytes are the sizes requested, peak heap is in the allocator's usable block sizes (a little
+// more) and measured above what was live when the phase started; peak RSS is '-' when the
+// kernel doesn't let us reset the high-water mark (/proc/self/clear_refs)
+void memstat_print_header(FILE* out);
+void memstat_print_row(FILE* out, const char* day, const char* phase, const MemSample* sample);
+
+#endif
@@ -0,0 +1,140 @@
+#include "parallel.h"
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+size_t aoc_threads(void) {
+    const char* env = getenv("AOC_THREADS");
+    if (env && *env) {
+        const long n = strtol(env, NULL, 10);
+        if (n > 0) {
+            return (size_t) n;
+        }
+    }
+
+    const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+    return cores > 0 ? (size_t) cores : 1;
+}
+
+typedef struct {
+    void (*fn)(size_t i, void* ctx);
+    void* ctx;
+    size_t n;
+    atomic_size_t next;
+} Work;
+
+static void* worker(void* arg) {
+    Work* work = arg;
+    for (size_t i = atomic_fetch_add(&work->next, 1); i < work->n; i = atomic_fetch_add(&work->next, 1)) {
+        work->fn(i, work->ctx);
+    }
+    return NULL;
+}
+
+void aoc_parallel_for(const size_t n, size_t threads, void (*fn)(size_t i, void* ctx), void* ctx) {
+    if (threads > n) {
+        threads = n;
+    }
+
+    Work work = { .fn = fn, .ctx = ctx, .n = n };
+    atomic_init(&work.next, 0);
+    if (threads <= 1) {
+        worker(&work);
+        return;
+    }
+
+    pthread_t* pool = malloc(sizeof(pthread_t) * (threads - 1));
+    size_t started = 0;
+    if (pool) {
+        for (; started < threads - 1; started++) {
+            if (pthread_create(&pool[started], NULL, worker, &work) != 0) {
+                perror("pthread_create");
+                break;
+            }
+        }
+    }
+
+    // the calling thread works too and picks up whatever the others don't
+    worker(&work);
+
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(pool[i], NULL);
+    }
+    free(pool);
+}
+
+struct AocTeam {
+    void (*fn)(AocTeam* team, size_t i, size_t n, void* ctx);
+    void* ctx;
+    size_t n;
+    // members wait for `ready` until the team size, and so the barrier, is known
+    pthread_mutex_t lock;
+    pthread_cond_t start;
+    bool ready;
+    pthread_barrier_t barrier;
+};
+
+typedef struct {
+    AocTeam* team;
+    size_t i;
+} Member;
+
+static void* member(void* arg) {
+    const Member* m = arg;
+    AocTeam* team = m->team;
+
+    pthread_mutex_lock(&team->lock);
+    while (!team->ready) {
+        pthread_cond_wait(&team->start, &team->lock);
+    }
+    pthread_mutex_unlock(&team->lock);
+
+    team->fn(team, m->i, team->n, team->ctx);
+    return NULL;
+}
+
+void aoc_parallel_team(const size_t threads, void (*fn)(AocTeam* team, size_t i, size_t n, void* ctx), void* ctx) {
+    AocTeam team = { .fn = fn, .ctx = ctx, .ready = false };
+    pthread_mutex_init(&team.lock, NULL);
+    pthread_cond_init(&team.start, NULL);
+
+    const size_t helpers = threads > 1 ? threads - 1 : 0;
+    pthread_t* pool = helpers ? malloc(sizeof(pthread_t) * helpers) : NULL;
+    Member* members = helpers ? malloc(sizeof(Member) * helpers) : NULL;
+    size_t started = 0;
+    if (pool && members) {
+        for (; started < helpers; started++) {
+            members[started] = (Member) { &team, started + 1 };
+            if (pthread_create(&pool[started], NULL, member, &members[started]) != 0) {
+                perror("pthread_create");
+                break;
+            }
+        }
+    }
+
+    pthread_mutex_lock(&team.lock);
+    team.n = started + 1;
+    pthread_barrier_init(&team.barrier, NULL, (unsigned) team.n);
+    team.ready = true;
+    pthread_cond_broadcast(&team.start);
+    pthread_mutex_unlock(&team.lock);
+
+    // the calling thread is member 0
+    fn(&team, 0, team.n, ctx);
+
+    for (size_t i = 0; i < started; i++) {
+        pthread_join(pool[i], NULL);
+    }
+    free(pool);
+    free(members);
+    pthread_barrier_destroy(&team.barrier);
+    pthread_cond_destroy(&team.start);
+    pthread_mutex_destroy(&team.lock);
+}
+
+bool aoc_team_barrier(AocTeam* team) {
+    return pthread_barrier_wait(&team->barrier) == PTHREAD_BARRIER_SERIAL_THREAD;
+}
@@ -0,0 +1,25 @@
+#ifndef AOC_PARALLEL_H
+#define AOC_PARALLEL_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// number of worker threads to use: $AOC_THREADS if set, otherwise the number of online cores
+size_t aoc_threads(void);
+
+// calls fn(i, ctx) for every i in [0, n) on up to `threads` threads, handing out
+// indices dynamically so that jobs of very different cost still balance
+void aoc_parallel_for(size_t n, size_t threads, void (*fn)(size_t i, void* ctx), void* ctx);
+
+typedef struct AocTeam AocTeam;
+
+// runs fn(team, i, n, ctx) on n <= `threads` threads at the same time, one call for every i in
+// [0, n), for work that proceeds in lockstep (rounds separated by aoc_team_barrier); n is fewer
+// than asked for only if threads couldn't be started
+void aoc_parallel_team(size_t threads, void (*fn)(AocTeam* team, size_t i, size_t n, void* ctx), void* ctx);
+
+// waits until all n members of the team have called it; true for exactly one of them, which
+// can then do the serial part of a round before the next barrier
+bool aoc_team_barrier(AocTeam* team);
+
+#endif
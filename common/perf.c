@@ -0,0 +1,123 @@
+#include "perf.h"
+
+#include <inttypes.h>
+#include <string.h>
+
+static const char* const COUNTER_NAMES[PERF_N_COUNTERS] = {
+    [PERF_CYCLES] = "cycles",
+    [PERF_INSTRUCTIONS] = "instructions",
+    [PERF_L1D_MISSES] = "L1d-misses",
+    [PERF_LLC_MISSES] = "LLC-misses",
+    [PERF_BRANCH_MISSES] = "branch-misses",
+};
+
+#ifdef AOC_PERF
+
+#include <errno.h>
+#include <linux/perf_event.h>
+#include <stdatomic.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+
+static const struct {
+    uint32_t type;
+    uint64_t config;
+} EVENTS[PERF_N_COUNTERS] = {
+    [PERF_CYCLES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+    [PERF_INSTRUCTIONS] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+    [PERF_L1D_MISSES] = {
+        PERF_TYPE_HW_CACHE,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    },
+    [PERF_LLC_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+    [PERF_BRANCH_MISSES] = { PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+};
+
+static atomic_bool warned = false;
+
+void perf_begin(PerfCounters* counters) {
+    // the reason the first counter failed to open, before later opens overwrite errno
+    int failure = 0;
+    for (size_t i = 0; i < PERF_N_COUNTERS; i++) {
+        struct perf_event_attr attr;
+        memset(&attr, 0, sizeof(attr));
+        attr.size = sizeof(attr);
+        attr.type = EVENTS[i].type;
+        attr.config = EVENTS[i].config;
+        attr.disabled = 1;
+        attr.inherit = 1;
+        attr.exclude_kernel = 1;
+        attr.exclude_hv = 1;
+        // the PMU may have fewer counters than we ask for; the kernel then multiplexes and we scale
+        attr.read_format = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        counters->fds[i] = (int) syscall(SYS_perf_event_open, &attr, 0, -1, -1, 0);
+        if (counters->fds[i] < 0 && !failure) {
+            failure = errno;
+        }
+    }
+
+    if (failure && !atomic_exchange(&warned, true)) {
+        fprintf(stderr, "some hardware counters are unavailable (%s); check the PMU and kernel.perf_event_paranoid\n", strerror(failure));
+    }
+
+    for (size_t i = 0; i < PERF_N_COUNTERS; i++) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_RESET, 0);
+            ioctl(counters->fds[i], PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+}
+
+void perf_end(PerfCounters* counters, PerfSample* sample) {
+    for (size_t i = 0; i < PERF_N_COUNTERS; i++) {
+        if (counters->fds[i] >= 0) {
+            ioctl(counters->fds[i], PERF_EVENT_IOC_DISABLE, 0);
+        }
+    }
+
+    for (size_t i = 0; i < PERF_N_COUNTERS; i++) {
+        sample->counted[i] = false;
+        sample->value[i] = 0;
+        if (counters->fds[i] < 0) {
+            continue;
+        }
+
+        uint64_t values[3];
+        if (read(counters->fds[i], values, sizeof(values)) == (ssize_t) sizeof(values) && values[2] > 0) {
+            const double scale = (double) values[1] / (double) values[2];
+            sample->counted[i] = true;
+            sample->value[i] = (uint64_t) ((double) values[0] * scale);
+        }
+        close(counters->fds[i]);
+    }
+}
+
+#endif
+
+void perf_print_header(FILE* out) {
+    fprintf(out, "%-6s %-7s", "day", "phase");
+    for (size_t i = 0; i < PERF_N_COUNTERS; i++) {
+        fprintf(out, " %15s", COUNTER_NAMES[i]);
+    }
+    fprintf(out, " %6s\n", "IPC");
+}
+
+void perf_print_row(FILE* out, const char* day, const char* phase, const PerfSample* sample) {
+    fprintf(out, "%-6s %-7s", day, phase);
+    for (size_t i = 0; i < PERF_N_COUNTERS; i++) {
+        if (sample->counted[i]) {
+            fprintf(out, " %15" PRIu64, sample->value[i]);
+        } else {
+            fprintf(out, " %15s", "-");
+        }
+    }
+
+    const bool has_ipc = sample->counted[PERF_CYCLES] && sample->counted[PERF_INSTRUCTIONS] && sample->value[PERF_CYCLES];
+    if (has_ipc) {
+        fprintf(out, " %6.2f\n", (double) sample->value[PERF_INSTRUCTIONS] / (double) sample->value[PERF_CYCLES]);
+    } else {
+        fprintf(out, " %6s\n", "-");
+    }
+}
@@ -0,0 +1,48 @@
+#ifndef AOC_PERF_H
+#define AOC_PERF_H
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+// Hardware counters around a phase, read through perf_event_open. Only compiled in with
+// -DAOC_PERF=ON; otherwise PERF_BEGIN/PERF_END expand to nothing and no counter is ever opened.
+typedef enum {
+    PERF_CYCLES,
+    PERF_INSTRUCTIONS,
+    PERF_L1D_MISSES,
+    PERF_LLC_MISSES,
+    PERF_BRANCH_MISSES,
+    PERF_N_COUNTERS,
+} PerfCounter;
+
+typedef struct {
+    bool counted[PERF_N_COUNTERS];
+    uint64_t value[PERF_N_COUNTERS];
+} PerfSample;
+
+#ifdef AOC_PERF
+
+typedef struct {
+    int fds[PERF_N_COUNTERS];
+} PerfCounters;
+
+// counts the calling thread and every thread it starts until perf_end
+void perf_begin(PerfCounters* counters);
+void perf_end(PerfCounters* counters, PerfSample* sample);
+
+#define PERF_BEGIN(name) PerfCounters name; perf_begin(&name)
+#define PERF_END(name, sample) perf_end(&name, (sample))
+
+#else
+
+#define PERF_BEGIN(name) ((void) 0)
+#define PERF_END(name, sample) ((void) 0)
+
+#endif
+
+// one row per phase: counters that couldn't be opened (no PMU, perf_event_paranoid, ...) print as '-'
+void perf_print_header(FILE* out);
+void perf_print_row(FILE* out, const char* day, const char* phase, const PerfSample* sample);
+
+#endif
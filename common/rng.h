@@ -0,0 +1,32 @@
+#ifndef AOC_RNG_H
+#define AOC_RNG_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// splitmix64: tiny, fast and good enough for generating inputs; same seed, same output everywhere
+typedef struct {
+    uint64_t state;
+} Rng;
+
+static inline Rng rng_seed(const uint64_t seed) {
+    return (Rng) { seed };
+}
+
+static inline uint64_t rng_next(Rng* rng) {
+    uint64_t z = (rng->state += 0x9e3779b97f4a7c15ull);
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ull;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebull;
+    return z ^ (z >> 31);
+}
+
+// uniform in [lo, hi]; the modulo bias is irrelevant at these ranges
+static inline uint64_t rng_range(Rng* rng, const uint64_t lo, const uint64_t hi) {
+    return lo + rng_next(rng) % (hi - lo + 1);
+}
+
+static inline bool rng_chance(Rng* rng, const unsigned percent) {
+    return rng_next(rng) % 100 < percent;
+}
+
+#endif
@@ -0,0 +1,278 @@
+#include <stdbool.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "aoc.h"
+#include "memstat.h"
+#include "parallel.h"
+#include "perf.h"
+
+typedef struct {
+    const AocDay* day;
+    bool parse_successful;
+    size_t p1, p2;
+    double parse_ms, parse2_ms, part1_ms, part2_ms;
+    PerfSample parse_perf, parse2_perf, part1_perf, part2_perf;
+    MemSample parse_mem, parse2_mem, part1_mem, part2_mem;
+} Job;
+
+typedef struct {
+    const char* input_dir;
+    const char* input;
+    bool part1, part2;
+    Job* jobs;
+} Run;
+
+static void runJob(const size_t i, void* ctx) {
+    const Run* run = ctx;
+    Job* job = &run->jobs[i];
+    const AocDay* day = job->day;
+
+    char path[4096];
+    if (run->input) {
+        snprintf(path, sizeof(path), "%s", run->input);
+    } else {
+        snprintf(path, sizeof(path), "%s/%s.txt", run->input_dir, day->name);
+    }
+
+    // a day with a dedicated part 2 parser doesn't need the shared parse for part 2 alone
+    void* data = NULL;
+    if (run->part1 || !day->parse_part2) {
+        MEMSTAT_BEGIN(parse_mark);
+        PERF_BEGIN(parse_counters);
+        const double start = aoc_now_ms();
+        data = day->parse(path);
+        job->parse_ms = aoc_now_ms() - start;
+        PERF_END(parse_counters, &job->parse_perf);
+        MEMSTAT_END(parse_mark, &job->parse_mem);
+        if (!data) {
+            return;
+        }
+    }
+
+    if (run->part1) {
+        MEMSTAT_BEGIN(part1_mark);
+        PERF_BEGIN(part1_counters);
+        const double start = aoc_now_ms();
+        job->p1 = day->part1(data);
+        job->part1_ms = aoc_now_ms() - start;
+        PERF_END(part1_counters, &job->part1_perf);
+        MEMSTAT_END(part1_mark, &job->part1_mem);
+    }
+
+    if (run->part2) {
+        void* data2 = data;
+        if (day->parse_part2) {
+            MEMSTAT_BEGIN(parse2_mark);
+            PERF_BEGIN(parse2_counters);
+            const double start = aoc_now_ms();
+            data2 = day->parse_part2(path);
+            job->parse2_ms = aoc_now_ms() - start;
+            PERF_END(parse2_counters, &job->parse2_perf);
+            MEMSTAT_END(parse2_mark, &job->parse2_mem);
+            if (!data2) {
+                goto end;
+            }
+        }
+
+        MEMSTAT_BEGIN(part2_mark);
+        PERF_BEGIN(part2_counters);
+        const double start = aoc_now_ms();
+        job->p2 = day->part2(data2);
+        job->part2_ms = aoc_now_ms() - start;
+        PERF_END(part2_counters, &job->part2_perf);
+        MEMSTAT_END(part2_mark, &job->part2_mem);
+
+        if (day->parse_part2) {
+            day->release_part2(data2);
+        }
+    }
+    job->parse_successful = true;
+
+end:
+    if (data) {
+        day->release(data);
+    }
+}
+
+static void printJob(const Job* job, const Run* run) {
+    if (!job->parse_successful) {
+        if (run->input) {
+            printf("%s  unable to parse '%s'\n", job->day->name, run->input);
+        } else {
+            printf("%s  unable to parse '%s/%s.txt'\n", job->day->name, run->input_dir, job->day->name);
+        }
+        return;
+    }
+
+    printf("%s", job->day->name);
+    if (run->part1) {
+        printf("  Part 1: %-18zu", job->p1);
+    }
+    if (run->part2) {
+        printf("  Part 2: %-18zu", job->p2);
+    }
+
+    const bool separate_parse2 = job->day->parse_part2 != NULL;
+    const char* sep = "  [";
+    if (run->part1 || !separate_parse2) {
+        printf("%sparse %.3f ms", sep, job->parse_ms);
+        sep = " | ";
+    }
+    if (run->part2 && separate_parse2) {
+        printf("%sparse2 %.3f ms", sep, job->parse2_ms);
+        sep = " | ";
+    }
+    if (run->part1) {
+        printf("%spart1 %.3f ms", sep, job->part1_ms);
+    }
+    if (run->part2) {
+        printf(" | part2 %.3f ms", job->part2_ms);
+    }
+    printf("]\n");
+}
+
+#ifdef AOC_PERF
+static void printPerf(const Job* jobs, const size_t n_jobs, const Run* run) {
+    perf_print_header(stdout);
+    for (size_t i = 0; i < n_jobs; i++) {
+        const Job* job = &jobs[i];
+        if (!job->parse_successful) {
+            continue;
+        }
+
+        const bool separate_parse2 = job->day->parse_part2 != NULL;
+        if (run->part1 || !separate_parse2) {
+            perf_print_row(stdout, job->day->name, "parse", &job->parse_perf);
+        }
+        if (run->part2 && separate_parse2) {
+            perf_print_row(stdout, job->day->name, "parse2", &job->parse2_perf);
+        }
+        if (run->part1) {
+            perf_print_row(stdout, job->day->name, "part1", &job->part1_perf);
+        }
+        if (run->part2) {
+            perf_print_row(stdout, job->day->name, "part2", &job->part2_perf);
+        }
+    }
+}
+#endif
+
+#ifdef AOC_MEMSTAT
+static void printMemstat(const Job* jobs, const size_t n_jobs, const Run* run) {
+    memstat_print_header(stdout);
+    for (size_t i = 0; i < n_jobs; i++) {
+        const Job* job = &jobs[i];
+        if (!job->parse_successful) {
+            continue;
+        }
+
+        const bool separate_parse2 = job->day->parse_part2 != NULL;
+        if (run->part1 || !separate_parse2) {
+            memstat_print_row(stdout, job->day->name, "parse", &job->parse_mem);
+        }
+        if (run->part2 && separate_parse2) {
+            memstat_print_row(stdout, job->day->name, "parse2", &job->parse2_mem);
+        }
+        if (run->part1) {
+            memstat_print_row(stdout, job->day->name, "part1", &job->part1_mem);
+        }
+        if (run->part2) {
+            memstat_print_row(stdout, job->day->name, "part2", &job->part2_mem);
+        }
+    }
+}
+#endif
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [-j threads] [-p 1|2] [-d input_dir | -i input] [day|from-to ...]\n"
+        "  runs the selected days (default: all) in parallel and reports per-phase wall time\n"
+        "  -i  run a single selected day on this input instead of <input_dir>/dayNN.txt; `-` reads stdin\n",
+        argv0);
+}
+
+int main(int argc, char** argv) {
+    Run run = { .input_dir = "inputs", .input = NULL, .part1 = true, .part2 = true, .jobs = NULL };
+    size_t threads = aoc_threads();
+    bool selected[AOC_N_DAYS] = { false };
+    bool any_selected = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-j") == 0 && i + 1 < argc) {
+            const long n = strtol(argv[++i], NULL, 10);
+            threads = n > 0 ? (size_t) n : 1;
+        } else if (strcmp(arg, "-p") == 0 && i + 1 < argc) {
+            const char* part = argv[++i];
+            run.part1 = strcmp(part, "1") == 0;
+            run.part2 = strcmp(part, "2") == 0;
+            if (!run.part1 && !run.part2) {
+                usage(argv[0]);
+                return 1;
+            }
+        } else if (strcmp(arg, "-d") == 0 && i + 1 < argc) {
+            run.input_dir = argv[++i];
+        } else if (strcmp(arg, "-i") == 0 && i + 1 < argc) {
+            run.input = argv[++i];
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else if (aoc_select_days(arg, selected)) {
+            any_selected = true;
+        } else {
+            fprintf(stderr, "invalid argument '%s'\n", arg);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (run.input) {
+        size_t n_selected = 0;
+        for (size_t d = 0; d < AOC_N_DAYS; d++) {
+            n_selected += selected[d];
+        }
+        if (n_selected != 1) {
+            fprintf(stderr, "-i needs exactly one day\n");
+            return 1;
+        }
+    }
+
+#ifdef AOC_MEMSTAT
+    // the allocation counters are process-wide, so days mustn't overlap
+    threads = 1;
+#endif
+
+    Job jobs[AOC_N_DAYS];
+    size_t n_jobs = 0;
+    for (size_t d = 0; d < AOC_N_DAYS; d++) {
+        if (!any_selected || selected[d]) {
+            jobs[n_jobs++] = (Job) { .day = AOC_DAYS[d] };
+        }
+    }
+    run.jobs = jobs;
+
+    const double start = aoc_now_ms();
+    aoc_parallel_for(n_jobs, threads, runJob, &run);
+    const double wall_ms = aoc_now_ms() - start;
+
+    int status = 0;
+    for (size_t i = 0; i < n_jobs; i++) {
+        printJob(&jobs[i], &run);
+        if (!jobs[i].parse_successful) {
+            status = 1;
+        }
+    }
+    printf("%zu day(s) in %.3f ms wall on %zu thread(s)\n", n_jobs, wall_ms, threads < n_jobs ? threads : n_jobs);
+#ifdef AOC_PERF
+    printf("\n");
+    printPerf(jobs, n_jobs, &run);
+#endif
+#ifdef AOC_MEMSTAT
+    printf("\n");
+    printMemstat(jobs, n_jobs, &run);
+#endif
+
+    return status;
+}
@@ -0,0 +1,216 @@
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "scan.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define AOC_SCAN_X86
+#include <immintrin.h>
+#endif
+
+typedef struct {
+    const char* (*find)(const char* p, const char* end, char c);
+    size_t (*count)(const char* p, const char* end, char c);
+    const char* (*skip_digits)(const char* p, const char* end);
+} ScanImpl;
+
+bool scan_swar = true;
+
+static const char* findScalar(const char* p, const char* end, const char c) {
+    for (; p < end; p++) {
+        if (*p == c) {
+            return p;
+        }
+    }
+    return end;
+}
+
+static size_t countScalar(const char* p, const char* end, const char c) {
+    size_t count = 0;
+    for (; p < end; p++) {
+        count += *p == c;
+    }
+    return count;
+}
+
+static const char* skipDigitsScalar(const char* p, const char* end) {
+    while (p < end && scan_is_digit(*p)) {
+        p++;
+    }
+    return p;
+}
+
+#ifdef AOC_SCAN_X86
+
+__attribute__((target("sse4.2"))) static const char* findSse42(const char* p, const char* end, const char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    for (; p + 16 <= end; p += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*) p);
+        const unsigned mask = (unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findScalar(p, end, c);
+}
+
+__attribute__((target("sse4.2"))) static size_t countSse42(const char* p, const char* end, const char c) {
+    const __m128i needle = _mm_set1_epi8(c);
+    size_t count = 0;
+    for (; p + 16 <= end; p += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*) p);
+        count += (size_t) __builtin_popcount((unsigned) _mm_movemask_epi8(_mm_cmpeq_epi8(chunk, needle)));
+    }
+    return count + countScalar(p, end, c);
+}
+
+// '0' <= c <= '9' as two signed compares: c > '0' - 1 and c < '9' + 1
+__attribute__((target("sse4.2"))) static const char* skipDigitsSse42(const char* p, const char* end) {
+    const __m128i lo = _mm_set1_epi8('0' - 1);
+    const __m128i hi = _mm_set1_epi8('9' + 1);
+    for (; p + 16 <= end; p += 16) {
+        const __m128i chunk = _mm_loadu_si128((const __m128i*) p);
+        const __m128i digits = _mm_and_si128(_mm_cmpgt_epi8(chunk, lo), _mm_cmplt_epi8(chunk, hi));
+        const unsigned other = ~(unsigned) _mm_movemask_epi8(digits) & 0xffffu;
+        if (other) {
+            return p + __builtin_ctz(other);
+        }
+    }
+    return skipDigitsScalar(p, end);
+}
+
+__attribute__((target("avx2"))) static const char* findAvx2(const char* p, const char* end, const char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    for (; p + 32 <= end; p += 32) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i*) p);
+        const unsigned mask = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle));
+        if (mask) {
+            return p + __builtin_ctz(mask);
+        }
+    }
+    return findScalar(p, end, c);
+}
+
+__attribute__((target("avx2,popcnt"))) static size_t countAvx2(const char* p, const char* end, const char c) {
+    const __m256i needle = _mm256_set1_epi8(c);
+    size_t count = 0;
+    for (; p + 32 <= end; p += 32) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i*) p);
+        count += (size_t) __builtin_popcount((unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(chunk, needle)));
+    }
+    return count + countScalar(p, end, c);
+}
+
+__attribute__((target("avx2"))) static const char* skipDigitsAvx2(const char* p, const char* end) {
+    const __m256i lo = _mm256_set1_epi8('0' - 1);
+    const __m256i hi = _mm256_set1_epi8('9' + 1);
+    for (; p + 32 <= end; p += 32) {
+        const __m256i chunk = _mm256_loadu_si256((const __m256i*) p);
+        const __m256i digits = _mm256_and_si256(_mm256_cmpgt_epi8(chunk, lo), _mm256_cmpgt_epi8(hi, chunk));
+        const unsigned other = ~(unsigned) _mm256_movemask_epi8(digits);
+        if (other) {
+            return p + __builtin_ctz(other);
+        }
+    }
+    return skipDigitsScalar(p, end);
+}
+
+#endif
+
+static const ScanImpl IMPLS[] = {
+    [SCAN_SCALAR] = { findScalar, countScalar, skipDigitsScalar },
+#ifdef AOC_SCAN_X86
+    [SCAN_SSE42] = { findSse42, countSse42, skipDigitsSse42 },
+    [SCAN_AVX2] = { findAvx2, countAvx2, skipDigitsAvx2 },
+#endif
+};
+
+static const char* const ISA_NAMES[] = {
+    [SCAN_SCALAR] = "scalar",
+    [SCAN_SSE42] = "sse42",
+    [SCAN_AVX2] = "avx2",
+};
+
+static ScanIsa current = SCAN_SCALAR;
+static const ScanImpl* impl = &IMPLS[SCAN_SCALAR];
+
+static bool supported(const ScanIsa isa) {
+    switch (isa) {
+    case SCAN_SCALAR:
+        return true;
+#ifdef AOC_SCAN_X86
+    case SCAN_SSE42:
+        return __builtin_cpu_supports("sse4.2");
+    case SCAN_AVX2:
+        return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("popcnt");
+#endif
+    default:
+        return false;
+    }
+}
+
+// runs before `main`, so the dispatch never changes under a running parser unless asked to
+__attribute__((constructor)) static void scanInit(void) {
+#ifdef AOC_SCAN_X86
+    __builtin_cpu_init();
+#endif
+    ScanIsa isa = SCAN_SCALAR;
+    for (ScanIsa candidate = SCAN_AVX2; candidate > SCAN_SCALAR; candidate--) {
+        if (supported(candidate)) {
+            isa = candidate;
+            break;
+        }
+    }
+
+    const char* env = getenv("AOC_SCAN");
+    ScanIsa requested;
+    if (env && *env) {
+        if (!scan_isa_parse(env, &requested) || !supported(requested)) {
+            fprintf(stderr, "AOC_SCAN='%s' isn't available here, using %s\n", env, ISA_NAMES[isa]);
+        } else {
+            isa = requested;
+        }
+    }
+    scan_use(isa);
+}
+
+ScanIsa scan_isa(void) {
+    return current;
+}
+
+const char* scan_isa_name(const ScanIsa isa) {
+    return (size_t) isa < sizeof(ISA_NAMES) / sizeof(*ISA_NAMES) ? ISA_NAMES[isa] : "?";
+}
+
+bool scan_isa_parse(const char* name, ScanIsa* isa) {
+    for (size_t i = 0; i < sizeof(ISA_NAMES) / sizeof(*ISA_NAMES); i++) {
+        if (strcmp(name, ISA_NAMES[i]) == 0) {
+            *isa = (ScanIsa) i;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool scan_use(const ScanIsa isa) {
+    if (!supported(isa)) {
+        return false;
+    }
+    current = isa;
+    impl = &IMPLS[isa];
+    scan_swar = isa != SCAN_SCALAR;
+    return true;
+}
+
+const char* scan_find(const char* p, const char* end, const char c) {
+    return impl->find(p, end, c);
+}
+
+size_t scan_count(const char* p, const char* end, const char c) {
+    return impl->count(p, end, c);
+}
+
+const char* scan_skip_digits(const char* p, const char* end) {
+    return impl->skip_digits(p, end);
+}
@@ -0,0 +1,96 @@
+#ifndef AOC_SCAN_H
+#define AOC_SCAN_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+
+// Byte scanning for the parsers: delimiter search and counting run 16 (SSE4.2) or 32 (AVX2)
+// bytes at a time, picked at startup from what the CPU supports; digit runs are converted
+// 8 bytes at a time with SWAR multiply-adds. $AOC_SCAN=scalar|sse42|avx2 overrides the choice;
+// scalar is the plain byte-at-a-time loops the parsers used before, kept as the baseline.
+typedef enum {
+    SCAN_SCALAR,
+    SCAN_SSE42,
+    SCAN_AVX2,
+} ScanIsa;
+
+// the level in use; solvers with vector kernels of their own pick them by it too, so that
+// scalar stays the baseline for everything
+ScanIsa scan_isa(void);
+const char* scan_isa_name(ScanIsa isa);
+bool scan_isa_parse(const char* name, ScanIsa* isa);
+
+// switches every scanner to `isa`; false (and nothing changes) if the CPU can't run it
+bool scan_use(ScanIsa isa);
+
+// first `c` in [p, end), or `end`
+const char* scan_find(const char* p, const char* end, char c);
+
+// occurrences of `c` in [p, end)
+size_t scan_count(const char* p, const char* end, char c);
+
+// first byte in [p, end) that isn't a decimal digit, or `end`
+const char* scan_skip_digits(const char* p, const char* end);
+
+extern bool scan_swar;
+
+static inline bool scan_is_digit(const char c) {
+    return '0' <= c && c <= '9';
+}
+
+// combines 8 little-endian digit values (0-9 per byte, '0' already subtracted) into one number
+static inline uint64_t scan_swar8(uint64_t chunk) {
+    chunk = (chunk * 10 + (chunk >> 8)) & 0x00ff00ff00ff00ffull;
+    chunk = (chunk * 100 + (chunk >> 16)) & 0x0000ffff0000ffffull;
+    chunk = (chunk * 10000 + (chunk >> 32)) & 0x00000000ffffffffull;
+    return chunk;
+}
+
+// number of leading bytes of `chunk` that are ASCII digits
+static inline unsigned scan_swar_digits(const uint64_t chunk) {
+    // a digit is 0x30-0x39: high nibble 3, and the low nibble doesn't carry when adding 6;
+    // carries only ever move towards later bytes, so the first non-digit is always found correctly
+    const uint64_t high = chunk & 0xf0f0f0f0f0f0f0f0ull;
+    const uint64_t low = ((chunk + 0x0606060606060606ull) & 0xf0f0f0f0f0f0f0f0ull) >> 4;
+    const uint64_t diff = (high | low) ^ 0x3333333333333333ull;
+    const uint64_t nonzero = (((diff & 0x7f7f7f7f7f7f7f7full) + 0x7f7f7f7f7f7f7f7full) | diff) & 0x8080808080808080ull;
+    return nonzero ? (unsigned) __builtin_ctzll(nonzero) / 8 : 8;
+}
+
+static const uint64_t SCAN_POW10[9] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000 };
+
+// parses the run of digits at `p` (none at all gives 0) and returns the first byte after it
+static inline const char* scan_uint(const char* p, const char* end, size_t* value) {
+    uint64_t res = 0;
+    if (scan_swar) {
+        while (p + 8 <= end) {
+            uint64_t chunk;
+            memcpy(&chunk, p, sizeof(chunk));
+
+            const unsigned n = scan_swar_digits(chunk);
+            if (n == 0) {
+                *value = (size_t) res;
+                return p;
+            }
+
+            // shifting the bytes after the run out at the top turns the gap at the front into leading zeros
+            const uint64_t digits = (chunk - 0x3030303030303030ull) << (8 - n) * 8;
+            res = res * SCAN_POW10[n] + scan_swar8(digits);
+            p += n;
+            if (n < 8) {
+                *value = (size_t) res;
+                return p;
+            }
+        }
+    }
+
+    for (; p < end && scan_is_digit(*p); p++) {
+        res = res * 10 + (uint64_t) (*p - '0');
+    }
+    *value = (size_t) res;
+    return p;
+}
+
+#endif
@@ -1,9 +1,20 @@
-#include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "aoc.h"
+#include "input.h"
+#include "parallel.h"
+#include "rng.h"
+#include "scan.h"
+
 typedef struct {
     char direction;
     size_t amount;
@@ -15,46 +26,41 @@ typedef struct {
     const bool parse_successful;
 } Data;
 
-size_t parseInt(const char* line, const size_t pos) {
-    size_t res = 0;
-    for (size_t i = pos; i < strlen(line) - 1; i++) {
-        res = res * 10 + (size_t) (line[i] - '0');
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
     }
-    return res;
-}
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+    // one rotation per line, so the array is allocated exactly once
+    const size_t n_lines = input_count_lines(&input);
+    Rotation* rotations = malloc(sizeof(Rotation) * (n_lines ? n_lines : 1));
+    if (!rotations) {
+        perror("Out of memory");
+        input_close(&input);
         goto error;
     }
 
-    Rotation* rotations = NULL;
-    char* line = NULL;
-    size_t n = 0, len;
-    while (getline(&line, &len, fp) >= 0) {
-        Rotation* new = realloc(rotations, sizeof(Rotation) * (n + 1));
-        if (!new) {
-            perror("Out of memory");
-            free(rotations);
-            free(line);
-            fclose(fp);
-            goto error;
+    // numbers may be read past the end of their line, the digit run stops at the '\n' anyway
+    const char* end = input.data + input.size;
+    size_t n = 0, pos = 0;
+    Line line;
+    while (input_next_line(&input, &pos, &line)) {
+        if (line.len < 2) {
+            continue;
         }
-
-        rotations = new;
-        rotations[n++] = (Rotation) { line[0], parseInt(line, 1) };
+        size_t amount;
+        scan_uint(line.str + 1, end, &amount);
+        rotations[n++] = (Rotation) { line.str[0], amount };
     }
 
-    free(line);
-    fclose(fp);
+    input_close(&input);
     return (Data) { rotations, n, true };
 error:
     return (Data) { NULL, 0, false };
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
     const Rotation* rotations = data->rotations;
     const size_t N = data->n;
 
@@ -80,7 +86,7 @@ size_t part1(const Data* data) {
     return times_zero;
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     const Rotation* rotations = data->rotations;
     const size_t N = data->n;
 
@@ -111,19 +117,499 @@ size_t part2(const Data* data) {
     return times_zero;
 }
 
-int main(void) {
-    const char* path = "inputs/day01.txt";
+static void freeData(const Data* data) {
+    free(data->rotations);
+}
+
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
+    }
+
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
+    }
+    return boxed;
+}
+
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
+
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// Streaming: both answers folded in one pass while reading, through a fixed buffer, so memory
+// stays O(1) however long the rotation log is. Part 1 only needs the dial position mod 100;
+// part 2 turns out not to depend on the position at all (see part2 above): every R adds
+// amount / 100, every L amount / 100 + 1.
+typedef struct {
+    size_t p1, p2;
+} Answers;
+
+#define STREAM_BUFFER (1 << 16)
+
+// `-o buffer=N`; aoc_check shrinks it so that small inputs go through refills and lines longer
+// than the buffer as well
+static size_t stream_buffer = STREAM_BUFFER;
+
+static bool configureStreaming(const char* option) {
+    if (!option) {
+        stream_buffer = STREAM_BUFFER;
+        return true;
+    }
+    return aoc_option_size(option, "buffer", &stream_buffer) && stream_buffer > 0;
+}
+
+static const char* const STREAMING_CHECKS[] = { "buffer=1", "buffer=3", "buffer=64", NULL };
+
+// `hits[p]` counts the rotations that left the dial at p; part 1 is `hits[0]` when starting at 50
+typedef struct {
+    unsigned position;
+    size_t hits[100];
+    size_t p2;
+    bool valid;
+} Dial;
+
+static void foldChunk(Dial* dial, const char* p, const char* end) {
+    while (p < end) {
+        const char* newline = scan_find(p, end, '\n');
+        if (newline - p >= 2) {
+            size_t amount;
+            scan_uint(p + 1, end, &amount);
+
+            const unsigned step = (unsigned) (amount % 100);
+            switch (*p) {
+            case 'L':
+                dial->position = (dial->position + 100 - step) % 100;
+                dial->p2 += amount / 100 + 1;
+                break;
+            case 'R':
+                dial->position = (dial->position + step) % 100;
+                dial->p2 += amount / 100;
+                break;
+            default:
+                if (dial->valid) {
+                    fprintf(stderr, "Unknown direction %d\n", *p);
+                }
+                dial->valid = false;
+                break;
+            }
+            dial->hits[dial->position]++;
+        }
+        p = newline + 1;
+    }
+}
+
+static void* parseStreaming(const char* path) {
+    InputStream stream;
+    if (!stream_open(&stream, path, stream_buffer)) {
+        return NULL;
+    }
+
+    Dial dial = { .position = 50, .hits = { 0 }, .p2 = 0, .valid = true };
+    Line chunk;
+    while (stream_next(&stream, &chunk)) {
+        foldChunk(&dial, chunk.str, chunk.str + chunk.len);
+    }
+    const bool failed = stream.failed;
+    stream_close(&stream);
+    if (failed) {
+        return NULL;
+    }
+
+    // like the reference, an unknown direction makes both answers 0
+    const Answers answers = dial.valid ? (Answers) { dial.hits[0], dial.p2 } : (Answers) { 0, 0 };
+    Answers* boxed = aoc_box(&answers, sizeof(answers));
+    if (!boxed) {
+        perror("Out of memory.");
     }
+    return boxed;
+}
+
+// Parallel: parse cuts the mapped input into chunks at line boundaries, and the parts fold every
+// chunk on its own, starting from position 0. A chunk's summary is its net turn mod 100 plus the
+// histogram of positions relative to its start, so once an exclusive scan over the net turns has
+// given each chunk its real starting position s, its part 1 hits are `hits[(100 - s) % 100]`.
+typedef struct {
+    Input input;
+    // chunk i is [cuts[i], cuts[i + 1]), empty where a cut landed inside a line an earlier cut
+    // already moved past
+    const char** cuts;
+    const size_t n_chunks;
+    const bool parse_successful;
+} Chunks;
+
+typedef struct {
+    const Chunks* chunks;
+    Dial* dials;
+} Summaries;
+
+static void summarizeChunk(const size_t i, void* ctx) {
+    const Summaries* summaries = ctx;
+    Dial* dial = &summaries->dials[i];
+    *dial = (Dial) { .position = 0, .hits = { 0 }, .p2 = 0, .valid = true };
+    foldChunk(dial, summaries->chunks->cuts[i], summaries->chunks->cuts[i + 1]);
+}
+
+// `-o chunks=N` cuts the input into exactly N chunks instead, however small; aoc_check uses it to
+// merge many chunks, some of them empty, on small inputs
+static size_t parallel_chunks = 0;
+
+static bool configureParallel(const char* option) {
+    if (!option) {
+        parallel_chunks = 0;
+        return true;
+    }
+    return aoc_option_size(option, "chunks", &parallel_chunks) && parallel_chunks > 0;
+}
+
+static const char* const PARALLEL_CHECKS[] = { "chunks=2", "chunks=7", "chunks=1000", NULL };
+
+static Chunks parseChunksFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
+    }
+
+    // a few chunks per thread so that uneven line lengths still balance
+    const size_t min_chunk = 1 << 16;
+    size_t n_chunks = aoc_threads() * 4;
+    if (n_chunks > input.size / min_chunk) {
+        n_chunks = input.size / min_chunk > 0 ? input.size / min_chunk : 1;
+    }
+    if (parallel_chunks) {
+        n_chunks = parallel_chunks;
+    }
+
+    const char** cuts = malloc(sizeof(const char*) * (n_chunks + 1));
+    if (!cuts) {
+        perror("Out of memory.");
+        input_close(&input);
+        goto error;
+    }
+
+    // every cut but the first moves on to the start of the next line
+    const char* end = input.data + input.size;
+    cuts[0] = input.data;
+    cuts[n_chunks] = end;
+    for (size_t i = 1; i < n_chunks; i++) {
+        const char* cut = input.data + input.size / n_chunks * i;
+        const char* newline = scan_find(cut > cuts[i - 1] ? cut : cuts[i - 1], end, '\n');
+        cuts[i] = newline < end ? newline + 1 : end;
+    }
+
+    return (Chunks) { input, cuts, n_chunks, true };
+error:
+    return (Chunks) { { NULL, 0, false }, NULL, 0, false };
+}
+
+// both answers from the chunk summaries, folded in parallel and combined in order
+static Answers foldChunks(const Chunks* chunks) {
+    Dial* dials = malloc(sizeof(Dial) * chunks->n_chunks);
+    if (!dials) {
+        perror("Out of memory.");
+        return (Answers) { 0, 0 };
+    }
+
+    Summaries summaries = { .chunks = chunks, .dials = dials };
+    aoc_parallel_for(chunks->n_chunks, aoc_threads(), summarizeChunk, &summaries);
+
+    Answers answers = { 0, 0 };
+    bool valid = true;
+    unsigned start = 50;
+    for (size_t i = 0; i < chunks->n_chunks; i++) {
+        answers.p1 += dials[i].hits[(100 - start) % 100];
+        answers.p2 += dials[i].p2;
+        valid &= dials[i].valid;
+        start = (start + dials[i].position) % 100;
+    }
+    free(dials);
+
+    return valid ? answers : (Answers) { 0, 0 };
+}
+
+static size_t parallelPart1(const void* data) {
+    return foldChunks(data).p1;
+}
+
+static size_t parallelPart2(const void* data) {
+    return foldChunks(data).p2;
+}
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+static void* parseParallel(const char* path) {
+    const Chunks chunks = parseChunksFile(path);
+    if (!chunks.parse_successful) {
+        return NULL;
+    }
+
+    Chunks* boxed = aoc_box(&chunks, sizeof(chunks));
+    if (!boxed) {
+        perror("Out of memory.");
+        Input input = chunks.input;
+        input_close(&input);
+        free(chunks.cuts);
+    }
+    return boxed;
+}
+
+static void releaseParallel(void* data) {
+    Chunks* chunks = data;
+    input_close(&chunks->input);
+    free(chunks->cuts);
+    free(data);
+}
+
+static size_t foldedPart1(const void* data) {
+    return ((const Answers*) data)->p1;
+}
+
+static size_t foldedPart2(const void* data) {
+    return ((const Answers*) data)->p2;
+}
+
+// Packed: one int32 per rotation, the amount for R and its complement ~amount for L (so that
+// L0 stays distinguishable from R0), and kernels without a data-dependent branch. Part 1 turns
+// every delta into a clockwise step in [0, 100) and counts zeros in the running sum mod 100;
+// part 2 is the sum of amount / 100 plus one per L. Both have an AVX2 version, picked when the
+// scanner runs at the AVX2 level.
+typedef struct {
+    int32_t* deltas;
+    const size_t n;
+    // an unknown direction makes both answers 0, like in the reference
+    const bool valid;
+    const bool parse_successful;
+} Packed;
+
+static Packed parsePackedFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
+    }
+
+    const size_t n_lines = input_count_lines(&input);
+    int32_t* deltas = malloc(sizeof(int32_t) * (n_lines ? n_lines : 1));
+    if (!deltas) {
+        perror("Out of memory.");
+        input_close(&input);
+        goto error;
+    }
+
+    const char* end = input.data + input.size;
+    size_t n = 0, pos = 0;
+    bool valid = true;
+    Line line;
+    while (input_next_line(&input, &pos, &line)) {
+        if (line.len < 2) {
+            continue;
+        }
+        size_t amount;
+        scan_uint(line.str + 1, end, &amount);
+
+        const int32_t delta = (int32_t) amount;
+        if (line.str[0] != 'L' && line.str[0] != 'R') {
+            if (valid) {
+                fprintf(stderr, "Unknown direction %d\n", line.str[0]);
+            }
+            valid = false;
+        }
+        deltas[n++] = line.str[0] == 'L' ? ~delta : delta;
+    }
+
+    input_close(&input);
+    return (Packed) { deltas, n, valid, true };
+error:
+    return (Packed) { NULL, 0, false, false };
+}
+
+// the amount and an all-ones mask for L
+static inline uint32_t unpack(const int32_t delta, uint32_t* left) {
+    *left = (uint32_t) (delta >> 31);
+    return (uint32_t) delta ^ *left;
+}
+
+static size_t zerosScalar(const int32_t* deltas, const size_t n, uint32_t* position) {
+    size_t zeros = 0;
+    uint32_t pos = *position;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t left;
+        const uint32_t rem = unpack(deltas[i], &left) % 100;
+        // a left turn by rem is a right turn by 100 - rem, and by 0 when rem is 0
+        const uint32_t step = ((100 - rem) & left) | (rem & ~left);
+        pos += step;
+        pos -= 100 & -(uint32_t) (pos >= 100);
+        pos -= 100 & -(uint32_t) (pos >= 100);
+        zeros += pos == 0;
+    }
+    *position = pos;
+    return zeros;
+}
+
+static size_t clicksScalar(const int32_t* deltas, const size_t n) {
+    size_t clicks = 0;
+    for (size_t i = 0; i < n; i++) {
+        uint32_t left;
+        clicks += unpack(deltas[i], &left) / 100 + (left & 1);
+    }
+    return clicks;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// x / 100 for every unsigned 32-bit lane: multiply by ceil(2^37 / 100) and keep the top bits
+__attribute__((target("avx2"))) static inline __m256i div100(const __m256i x) {
+    const __m256i magic = _mm256_set1_epi32((int) 0x51eb851f);
+    const __m256i even = _mm256_srli_epi64(_mm256_mul_epu32(x, magic), 37);
+    const __m256i odd = _mm256_srli_epi64(_mm256_mul_epu32(_mm256_srli_epi64(x, 32), magic), 37);
+    return _mm256_blend_epi32(even, _mm256_slli_epi64(odd, 32), 0xaa);
+}
+
+__attribute__((target("avx2,popcnt"))) static size_t zerosAvx2(const int32_t* deltas, const size_t n, uint32_t* position) {
+    const __m256i hundred = _mm256_set1_epi32(100);
+    const __m256i last = _mm256_set1_epi32(7);
+    __m256i carry = _mm256_set1_epi32((int) *position);
+    size_t zeros = 0, i = 0;
+
+    for (; i + 8 <= n; i += 8) {
+        const __m256i delta = _mm256_loadu_si256((const __m256i*) (deltas + i));
+        const __m256i left = _mm256_srai_epi32(delta, 31);
+        const __m256i amount = _mm256_xor_si256(delta, left);
+        const __m256i rem = _mm256_sub_epi32(amount, _mm256_mullo_epi32(div100(amount), hundred));
+
+        __m256i step = _mm256_blendv_epi8(rem, _mm256_sub_epi32(hundred, rem), left);
+        step = _mm256_sub_epi32(step, _mm256_and_si256(_mm256_cmpeq_epi32(step, hundred), hundred));
+
+        // inclusive prefix sum of the 8 steps, then the position before them on top
+        step = _mm256_add_epi32(step, _mm256_slli_si256(step, 4));
+        step = _mm256_add_epi32(step, _mm256_slli_si256(step, 8));
+        step = _mm256_add_epi32(step, _mm256_permute2x128_si256(_mm256_shuffle_epi32(step, 0xff), step, 0x08));
+        __m256i pos = _mm256_add_epi32(step, carry);
+
+        // pos < 900, where x * 5243 >> 19 is x / 100
+        const __m256i q = _mm256_srli_epi32(_mm256_mullo_epi32(pos, _mm256_set1_epi32(5243)), 19);
+        pos = _mm256_sub_epi32(pos, _mm256_mullo_epi32(q, hundred));
+
+        const __m256i zero = _mm256_cmpeq_epi32(pos, _mm256_setzero_si256());
+        zeros += (size_t) __builtin_popcount((unsigned) _mm256_movemask_ps(_mm256_castsi256_ps(zero)));
+        carry = _mm256_permutevar8x32_epi32(pos, last);
+    }
+
+    *position = (uint32_t) _mm256_cvtsi256_si32(carry);
+    return zeros + zerosScalar(deltas + i, n - i, position);
+}
+
+__attribute__((target("avx2"))) static size_t clicksAvx2(const int32_t* deltas, const size_t n) {
+    size_t clicks = 0, i = 0;
+    while (i + 8 <= n) {
+        // every lane adds at most 2^31 / 100 + 1 per step, so 64 steps can't overflow 32 bits
+        __m256i sum = _mm256_setzero_si256();
+        for (size_t block = 0; block < 64 && i + 8 <= n; block++, i += 8) {
+            const __m256i delta = _mm256_loadu_si256((const __m256i*) (deltas + i));
+            const __m256i left = _mm256_srai_epi32(delta, 31);
+            const __m256i amount = _mm256_xor_si256(delta, left);
+            sum = _mm256_sub_epi32(_mm256_add_epi32(sum, div100(amount)), left);
+        }
+
+        const __m256i wide = _mm256_add_epi64(
+            _mm256_cvtepu32_epi64(_mm256_castsi256_si128(sum)), _mm256_cvtepu32_epi64(_mm256_extracti128_si256(sum, 1)));
+        uint64_t lanes[4];
+        _mm256_storeu_si256((__m256i*) lanes, wide);
+        clicks += (size_t) (lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+    }
+    return clicks + clicksScalar(deltas + i, n - i);
+}
+
+#endif
+
+static size_t packedPart1(const void* data) {
+    const Packed* packed = data;
+    if (!packed->valid) {
+        return 0;
+    }
+
+    uint32_t position = 50;
+#if defined(__x86_64__) || defined(__i386__)
+    if (scan_isa() == SCAN_AVX2) {
+        return zerosAvx2(packed->deltas, packed->n, &position);
+    }
+#endif
+    return zerosScalar(packed->deltas, packed->n, &position);
+}
+
+static size_t packedPart2(const void* data) {
+    const Packed* packed = data;
+    if (!packed->valid) {
+        return 0;
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+    if (scan_isa() == SCAN_AVX2) {
+        return clicksAvx2(packed->deltas, packed->n);
+    }
+#endif
+    return clicksScalar(packed->deltas, packed->n);
+}
+
+static void* parsePacked(const char* path) {
+    const Packed packed = parsePackedFile(path);
+    if (!packed.parse_successful) {
+        return NULL;
+    }
+
+    Packed* boxed = aoc_box(&packed, sizeof(packed));
+    if (!boxed) {
+        perror("Out of memory.");
+        free(packed.deltas);
+    }
+    return boxed;
+}
+
+static void releasePacked(void* data) {
+    free(((Packed*) data)->deltas);
+    free(data);
+}
+
+static const AocVariant VARIANTS[] = {
+    { .name = "streaming", .part1 = foldedPart1, .part2 = foldedPart2, .parse = parseStreaming, .release = free,
+      .configure = configureStreaming, .options = "buffer=N: read through an N byte buffer (default 65536)", .checks = STREAMING_CHECKS },
+    { .name = "parallel", .part1 = parallelPart1, .part2 = parallelPart2, .parse = parseParallel, .release = releaseParallel,
+      .configure = configureParallel, .options = "chunks=N: fold the input in N chunks (default 4 per thread, 64 KiB or more each)",
+      .checks = PARALLEL_CHECKS },
+    { .name = "packed", .part1 = packedPart1, .part2 = packedPart2, .parse = parsePacked, .release = releasePacked },
+};
+
+// `size` rotations with amounts in the puzzle's range
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    Rng rng = rng_seed(seed);
+    for (size_t i = 0; i < size; i++) {
+        const char direction = rng_chance(&rng, 50) ? 'L' : 'R';
+        fprintf(out, "%c%" PRIu64 "\n", direction, rng_range(&rng, 1, 999));
+    }
+    return !ferror(out);
+}
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+const AocDay day01 = {
+    .name = "day01",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+    .variants = VARIANTS,
+    .n_variants = sizeof(VARIANTS) / sizeof(*VARIANTS),
+};
 
-    free(data.rotations);
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day01, argc, argv);
 }
+#endif
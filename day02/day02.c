@@ -1,8 +1,20 @@
-#include <errno.h>
+#include <inttypes.h>
+#include <pthread.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <unistd.h>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "aoc.h"
+#include "input.h"
+#include "parallel.h"
+#include "rng.h"
+#include "scan.h"
 
 typedef struct {
     size_t start;
@@ -15,66 +27,52 @@ typedef struct {
     const bool parse_successful;
 } Data;
 
-size_t parseInt(const char* line, const size_t start, const size_t end) {
-    size_t res = 0;
-    for (size_t i = start; i < end; i++) {
-        res = res * 10 + (size_t) (line[i] - '0');
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
     }
-    return res;
-}
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+    size_t pos = 0;
+    Line line;
+    if (!input_next_line(&input, &pos, &line)) {
+        input_close(&input);
         goto error;
     }
 
-    char* line = NULL;
-    size_t len;
-    if (getline(&line, &len, fp) < 0) {
-        fclose(fp);
+    // ranges are separated by ',', so the array is allocated exactly once
+    const size_t n_ranges = input_count_char(line.str, line.len, ',') + 1;
+    Range* ranges = malloc(sizeof(Range) * n_ranges);
+    if (!ranges) {
+        perror("Out of memory.");
+        input_close(&input);
         goto error;
     }
-    fclose(fp);
 
     size_t n = 0;
-    Range* ranges = NULL;
-    for (size_t i = 0; i < strlen(line); ) {
-        size_t start = i;
-        while ('0' <= line[i] && line[i] <= '9') {
-            i++;
-        }
+    const char* p = line.str;
+    const char* line_end = line.str + line.len;
+    const char* end = input.data + input.size;
+    while (p < line_end && n < n_ranges) {
+        size_t first, second;
+        p = scan_uint(p, end, &first);
 
-        const size_t first = parseInt(line, start, i);
-
-        start = ++i;
-        while ('0' <= line[i] && line[i] <= '9') {
-            i++;
-        }
-        const size_t second = parseInt(line, start, i);
-
-        Range* new = realloc(ranges, sizeof(Range) * (n + 1));
-        if (!new) {
-            free(line);
-            free(ranges);
-            goto error;
-        }
+        // skip "-"
+        p = scan_uint(p + 1, end, &second);
 
-        ranges = new;
         ranges[n++] = (Range) { first, second };
 
         // skip ","
-        i++;
+        p++;
     }
 
-    free(line);
+    input_close(&input);
     return (Data) { ranges, n, true };
 error:
     return (Data) { NULL, 0, false };
 }
 
-bool isSelfRepeatingOnce(const size_t val) {
+static bool isSelfRepeatingOnce(const size_t val) {
     char num_str[21];
     sprintf(num_str, "%zu", val);
 
@@ -87,7 +85,7 @@ bool isSelfRepeatingOnce(const size_t val) {
     return memcmp(num_str, num_str + half, half) == 0;
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
     const Range* ranges = data->ranges;
     const size_t N = data->n;
 
@@ -103,27 +101,31 @@ size_t part1(const Data* data) {
     return sum;
 }
 
-bool isSelfRepeating(const size_t val) {
+static bool isSelfRepeating(const size_t val) {
     char num_str[21];
     sprintf(num_str, "%zu", val);
 
     const size_t len = strlen(num_str);
-    outer: for (size_t segment_len = 1; segment_len <= len / 2; segment_len++) {
+    for (size_t segment_len = 1; segment_len <= len / 2; segment_len++) {
         if (len % segment_len != 0) {
             continue;
         }
 
+        bool repeating = true;
         for (size_t j = 0; j < len / segment_len - 1; j++) {
             if (memcmp(num_str + j * segment_len, num_str + (j + 1) * segment_len, segment_len) != 0) {
-                continue outer;
+                repeating = false;
+                break;
             }
         }
-        return true;
+        if (repeating) {
+            return true;
+        }
     }
     return false;
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     const Range* ranges = data->ranges;
     const size_t N = data->n;
 
@@ -139,19 +141,728 @@ size_t part2(const Data* data) {
     return sum;
 }
 
-int main(void) {
-    const char* path = "inputs/day02_sample.txt";
+// Closed form: a number of `length` digits made of one `period`-digit seed repeated is seed * M with
+// M = 10...010...01 (length / period ones, `period` apart), so the ones in a range are consecutive
+// seeds and sum to M times an arithmetic series. Sums wrap modulo 2^64 exactly like the per-number
+// loops do.
+#define MAX_DIGITS 20
+
+static const size_t POW10[MAX_DIGITS] = {
+    1ull, 10ull, 100ull, 1000ull, 10000ull, 100000ull, 1000000ull, 10000000ull, 100000000ull, 1000000000ull,
+    10000000000ull, 100000000000ull, 1000000000000ull, 10000000000000ull, 100000000000000ull,
+    1000000000000000ull, 10000000000000000ull, 100000000000000000ull, 1000000000000000000ull,
+    10000000000000000000ull,
+};
+
+// lo + ... + hi, halving whichever factor is even so that only the final product wraps
+static size_t seriesSum(const size_t lo, const size_t hi) {
+    size_t count = hi - lo + 1, total = lo + hi;
+    if (count % 2 == 0) {
+        count /= 2;
+    } else {
+        total /= 2;
+    }
+    return count * total;
+}
+
+// sum of the `length`-digit numbers in [start, end] that repeat a `period`-digit seed
+static size_t periodicSum(const size_t start, const size_t end, const size_t length, const size_t period) {
+    size_t multiplier = 0;
+    for (size_t shift = 0; shift < length; shift += period) {
+        multiplier += POW10[shift];
+    }
+
+    // seeds have exactly `period` digits, which also keeps seed * M at exactly `length` digits
+    size_t lo = start / multiplier + (start % multiplier != 0);
+    size_t hi = end / multiplier;
+    const size_t min_seed = POW10[period - 1];
+    const size_t max_seed = period < MAX_DIGITS ? POW10[period] - 1 : SIZE_MAX;
+    lo = lo < min_seed ? min_seed : lo;
+    hi = hi > max_seed ? max_seed : hi;
+    return lo <= hi ? multiplier * seriesSum(lo, hi) : 0;
+}
+
+static size_t closedFormSum(const Range range, const bool any_repeat) {
+    size_t sum = 0;
+    for (size_t length = 2; length <= MAX_DIGITS; length++) {
+        const size_t first = POW10[length - 1];
+        const size_t last = length < MAX_DIGITS ? POW10[length] - 1 : SIZE_MAX;
+        if (range.end < first || range.start > last) {
+            continue;
+        }
+        const size_t start = range.start > first ? range.start : first;
+        const size_t end = range.end < last ? range.end : last;
+
+        if (!any_repeat) {
+            sum += length % 2 == 0 ? periodicSum(start, end, length, length / 2) : 0;
+            continue;
+        }
+
+        // every number with period p is counted once per multiple of its shortest period that
+        // divides p, so exact[p] (shortest period exactly p) is periodic(p) minus exact[d] for
+        // the proper divisors d of p; the answer is the sum over the proper divisors of `length`
+        size_t exact[MAX_DIGITS] = { 0 };
+        for (size_t period = 1; period < length; period++) {
+            if (length % period != 0) {
+                continue;
+            }
+            exact[period] = periodicSum(start, end, length, period);
+            for (size_t d = 1; d < period; d++) {
+                if (period % d == 0) {
+                    exact[period] -= exact[d];
+                }
+            }
+            sum += exact[period];
+        }
+    }
+    return sum;
+}
+
+static size_t closedFormPart1(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->n; i++) {
+        sum += closedFormSum(d->ranges[i], false);
+    }
+    return sum;
+}
+
+static size_t closedFormPart2(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->n; i++) {
+        sum += closedFormSum(d->ranges[i], true);
+    }
+    return sum;
+}
+
+// Indexed: every repeated number with at most INDEX_DIGITS digits, sorted, with prefix sums, so
+// a range is two binary searches and a subtraction. The index is built once per process (or
+// loaded from $AOC_CACHE_DIR/day02_index_<digits>.bin, and written there after a build) and is
+// read-only from then on, so any number of range batches can query it concurrently. Indexing up
+// to 10^18 would take about 10^9 numbers and 16 GB with the prefix sums, so numbers past
+// 10^INDEX_DIGITS (about 2 * 10^6 numbers, 32 MB) use the closed form instead.
+#define INDEX_DIGITS 12
+
+typedef struct {
+    size_t* values;
+    // prefix[i] is the sum of the first i values
+    size_t* prefix;
+    size_t n;
+} IdIndex;
+
+typedef struct {
+    // repeated exactly twice and repeated at least twice
+    IdIndex once, any;
+    bool built;
+} Index;
+
+static Index id_index;
+static pthread_once_t id_index_once = PTHREAD_ONCE_INIT;
+
+static const uint64_t INDEX_MAGIC = 0x5844493230636f61ull; // "aoc02IDX"
+
+static int compareSize(const void* a, const void* b) {
+    const size_t x = *(const size_t*) a, y = *(const size_t*) b;
+    return (x > y) - (x < y);
+}
+
+// fills in the prefix sums; false if `values` aren't strictly increasing, i.e. a corrupt cache
+static bool indexPrefix(IdIndex* index) {
+    index->prefix = malloc(sizeof(size_t) * (index->n + 1));
+    if (!index->prefix) {
+        perror("Out of memory.");
+        return false;
+    }
+
+    index->prefix[0] = 0;
+    for (size_t i = 0; i < index->n; i++) {
+        if (i && index->values[i] <= index->values[i - 1]) {
+            return false;
+        }
+        index->prefix[i + 1] = index->prefix[i] + index->values[i];
+    }
+    return true;
+}
+
+// numbers of `length` digits that repeat a `period`-digit seed, in increasing order
+static size_t* emitPeriodic(size_t* out, const size_t length, const size_t period) {
+    size_t multiplier = 0;
+    for (size_t shift = 0; shift < length; shift += period) {
+        multiplier += POW10[shift];
+    }
+    for (size_t seed = POW10[period - 1]; seed < POW10[period]; seed++) {
+        *out++ = seed * multiplier;
+    }
+    return out;
+}
+
+static bool buildIndex(Index* index) {
+    size_t n_once = 0, n_any = 0;
+    for (size_t length = 2; length <= INDEX_DIGITS; length++) {
+        for (size_t period = 1; period < length; period++) {
+            if (length % period == 0) {
+                n_any += POW10[period] - POW10[period - 1];
+            }
+        }
+        if (length % 2 == 0) {
+            n_once += POW10[length / 2] - POW10[length / 2 - 1];
+        }
+    }
+
+    index->once.values = malloc(sizeof(size_t) * n_once);
+    index->any.values = malloc(sizeof(size_t) * n_any);
+    if (!index->once.values || !index->any.values) {
+        perror("Out of memory.");
+        return false;
+    }
+
+    // lengths come in increasing order, so only the numbers of one length need sorting and dedup
+    size_t* once = index->once.values;
+    size_t* any = index->any.values;
+    for (size_t length = 2; length <= INDEX_DIGITS; length++) {
+        if (length % 2 == 0) {
+            once = emitPeriodic(once, length, length / 2);
+        }
+
+        size_t* first = any;
+        for (size_t period = 1; period < length; period++) {
+            if (length % period == 0) {
+                any = emitPeriodic(any, length, period);
+            }
+        }
+        qsort(first, (size_t) (any - first), sizeof(size_t), compareSize);
+
+        size_t* unique = first;
+        for (size_t* value = first; value < any; value++) {
+            if (unique == first || *value != unique[-1]) {
+                *unique++ = *value;
+            }
+        }
+        any = unique;
+    }
+
+    index->once.n = (size_t) (once - index->once.values);
+    index->any.n = (size_t) (any - index->any.values);
+    return indexPrefix(&index->once) && indexPrefix(&index->any);
+}
+
+static bool indexCachePath(char* path, const size_t size) {
+    const char* dir = getenv("AOC_CACHE_DIR");
+    if (!dir || !*dir) {
+        return false;
+    }
+    snprintf(path, size, "%s/day02_index_%d.bin", dir, INDEX_DIGITS);
+    return true;
+}
+
+static bool loadIndex(Index* index, const char* path) {
+    FILE* in = fopen(path, "rb");
+    if (!in) {
+        return false;
+    }
+
+    uint64_t header[4];
+    bool loaded = fread(header, sizeof(header), 1, in) == 1 && header[0] == INDEX_MAGIC && header[1] == INDEX_DIGITS;
+    if (loaded) {
+        index->once.n = (size_t) header[2];
+        index->any.n = (size_t) header[3];
+        index->once.values = malloc(sizeof(size_t) * (index->once.n ? index->once.n : 1));
+        index->any.values = malloc(sizeof(size_t) * (index->any.n ? index->any.n : 1));
+        loaded = index->once.values && index->any.values
+              && fread(index->once.values, sizeof(size_t), index->once.n, in) == index->once.n
+              && fread(index->any.values, sizeof(size_t), index->any.n, in) == index->any.n
+              && fgetc(in) == EOF
+              && indexPrefix(&index->once) && indexPrefix(&index->any);
+    }
+    fclose(in);
+
+    if (!loaded) {
+        fprintf(stderr, "Ignoring invalid index cache '%s'\n", path);
+    }
+    return loaded;
+}
+
+// written next to the final name and renamed, so a concurrent reader never sees half a file
+static void storeIndex(const Index* index, const char* path) {
+    char tmp[4096 + 32];
+    snprintf(tmp, sizeof(tmp), "%s.%ld", path, (long) getpid());
+    FILE* out = fopen(tmp, "wb");
+    if (!out) {
+        perror(tmp);
+        return;
+    }
+
+    const uint64_t header[4] = { INDEX_MAGIC, INDEX_DIGITS, index->once.n, index->any.n };
+    fwrite(header, sizeof(header), 1, out);
+    fwrite(index->once.values, sizeof(size_t), index->once.n, out);
+    fwrite(index->any.values, sizeof(size_t), index->any.n, out);
+    if (fclose(out) != 0 || rename(tmp, path) != 0) {
+        perror(path);
+        unlink(tmp);
+    }
+}
+
+static void freeIndex(Index* index) {
+    free(index->once.values);
+    free(index->once.prefix);
+    free(index->any.values);
+    free(index->any.prefix);
+    *index = (Index) { 0 };
+}
+
+static void initIndex(void) {
+    char path[4096];
+    const bool cached = indexCachePath(path, sizeof(path));
+    if (cached && loadIndex(&id_index, path)) {
+        id_index.built = true;
+        return;
+    }
+    freeIndex(&id_index);
+
+    id_index.built = buildIndex(&id_index);
+    if (!id_index.built) {
+        // every range takes the closed form then
+        freeIndex(&id_index);
+    } else if (cached) {
+        storeIndex(&id_index, path);
+    }
+}
+
+// how many indexed values are below `x`
+static size_t countBelow(const IdIndex* index, const size_t x) {
+    size_t lo = 0, hi = index->n;
+    while (lo < hi) {
+        const size_t mid = lo + (hi - lo) / 2;
+        if (index->values[mid] < x) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+static size_t indexedSum(const Range range, const bool any_repeat) {
+    pthread_once(&id_index_once, initIndex);
+    const IdIndex* index = any_repeat ? &id_index.any : &id_index.once;
+    if (!id_index.built) {
+        return closedFormSum(range, any_repeat);
+    }
+
+    const size_t limit = POW10[INDEX_DIGITS] - 1;
+    if (range.start > limit) {
+        return closedFormSum(range, any_repeat);
+    }
+
+    const size_t end = range.end < limit ? range.end : limit;
+    size_t sum = range.start <= end ? index->prefix[countBelow(index, end + 1)] - index->prefix[countBelow(index, range.start)] : 0;
+    if (range.end > limit) {
+        sum += closedFormSum((Range) { limit + 1, range.end }, any_repeat);
+    }
+    return sum;
+}
+
+static size_t indexedPart1(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->n; i++) {
+        sum += indexedSum(d->ranges[i], false);
+    }
+    return sum;
+}
+
+static size_t indexedPart2(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->n; i++) {
+        sum += indexedSum(d->ranges[i], true);
+    }
+    return sum;
+}
+
+// Arithmetic: the per-number check without formatting. A number of L digits repeats a p-digit seed
+// iff it is divisible by the multiplier M from the closed form (the quotient then always has p
+// digits), and repeating with period p implies it for every multiple of p dividing L, so part 2
+// only tests p = L / q for the primes q dividing L, at most two for 20 digits. M is odd, so
+// divisibility is a multiplication by its inverse mod 2^64 and a compare, no division. The batched
+// checker tests four consecutive candidates per AVX2 step, for ranges too irregular for the
+// closed form and as a cross-check of it.
+typedef struct {
+    // x % M == 0 iff x * inverse (mod 2^64) <= limit
+    size_t inverse, limit;
+} DivisorTest;
+
+typedef struct {
+    DivisorTest once[1], any[2];
+    size_t n_once, n_any;
+} RepeatTests;
+
+static RepeatTests repeat_tests[MAX_DIGITS + 1];
+
+static DivisorTest divisorTest(const size_t length, const size_t period) {
+    size_t multiplier = 0;
+    for (size_t shift = 0; shift < length; shift += period) {
+        multiplier += POW10[shift];
+    }
+
+    // Newton's iteration doubles the correct low bits each step, from 3 for any odd number
+    size_t inverse = multiplier;
+    for (size_t i = 0; i < 5; i++) {
+        inverse *= 2 - multiplier * inverse;
+    }
+    return (DivisorTest) { inverse, SIZE_MAX / multiplier };
+}
+
+__attribute__((constructor)) static void initRepeatTests(void) {
+    for (size_t length = 2; length <= MAX_DIGITS; length++) {
+        RepeatTests* tests = &repeat_tests[length];
+        if (length % 2 == 0) {
+            tests->once[tests->n_once++] = divisorTest(length, length / 2);
+        }
+        size_t rest = length;
+        for (size_t prime = 2; prime <= rest; prime++) {
+            if (rest % prime == 0) {
+                tests->any[tests->n_any++] = divisorTest(length, length / prime);
+                while (rest % prime == 0) {
+                    rest /= prime;
+                }
+            }
+        }
+    }
+}
+
+static size_t digitCount(const size_t value) {
+    const size_t guess = ((size_t) (64 - __builtin_clzll(value | 1)) * 1233) >> 12;
+    return guess + (value >= POW10[guess]);
+}
+
+static bool passesAny(const size_t value, const DivisorTest* tests, const size_t n_tests) {
+    bool passed = false;
+    for (size_t i = 0; i < n_tests; i++) {
+        passed |= value * tests[i].inverse <= tests[i].limit;
+    }
+    return passed;
+}
+
+static bool isRepeatedOnceArithmetic(const size_t value) {
+    const RepeatTests* tests = &repeat_tests[digitCount(value)];
+    return passesAny(value, tests->once, tests->n_once);
+}
+
+static bool isRepeatingArithmetic(const size_t value) {
+    const RepeatTests* tests = &repeat_tests[digitCount(value)];
+    return passesAny(value, tests->any, tests->n_any);
+}
+
+static size_t arithmeticPart1(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->n; i++) {
+        const Range r = d->ranges[i];
+        for (size_t j = r.start; j <= r.end; j++) {
+            if (isRepeatedOnceArithmetic(j)) {
+                sum += j;
+            }
+        }
+    }
+    return sum;
+}
+
+static size_t arithmeticPart2(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->n; i++) {
+        const Range r = d->ranges[i];
+        for (size_t j = r.start; j <= r.end; j++) {
+            if (isRepeatingArithmetic(j)) {
+                sum += j;
+            }
+        }
+    }
+    return sum;
+}
+
+static size_t checkedSumScalar(const size_t start, const size_t end, const DivisorTest* tests, const size_t n_tests) {
+    size_t sum = 0;
+    for (size_t j = start; j <= end; j++) {
+        sum += passesAny(j, tests, n_tests) ? j : 0;
+        if (j == SIZE_MAX) {
+            break;
+        }
+    }
+    return sum;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// low 64 bits of a 64 x 64 bit product per lane, from three 32 x 32 -> 64 bit products
+__attribute__((target("avx2"))) static inline __m256i mullo64(const __m256i a, const __m256i b) {
+    const __m256i cross = _mm256_add_epi64(_mm256_mul_epu32(_mm256_srli_epi64(a, 32), b), _mm256_mul_epu32(a, _mm256_srli_epi64(b, 32)));
+    return _mm256_add_epi64(_mm256_mul_epu32(a, b), _mm256_slli_epi64(cross, 32));
+}
+
+// sum of the numbers in [start, end] passing any test; all of them have the same length
+__attribute__((target("avx2"))) static size_t checkedSumAvx2(const size_t start, const size_t end, const DivisorTest* tests, const size_t n_tests) {
+    if (end - start < 4) {
+        return checkedSumScalar(start, end, tests, n_tests);
+    }
+
+    // unsigned compares as signed ones on values with the top bit flipped
+    const __m256i flip = _mm256_set1_epi64x(INT64_MIN);
+    // product <= limit as bound > product, with bound = limit + 1 (limit is at most 2^64 / 11)
+    __m256i inverse[2], bound[2];
+    for (size_t t = 0; t < n_tests; t++) {
+        inverse[t] = _mm256_set1_epi64x((long long) tests[t].inverse);
+        bound[t] = _mm256_xor_si256(_mm256_set1_epi64x((long long) (tests[t].limit + 1)), flip);
+    }
+
+    // the segment has at least one number of `length` >= 2 digits, so its count can't overflow
+    const size_t count = end - start + 1;
+    const __m256i step = _mm256_set1_epi64x(4);
+    __m256i value = _mm256_add_epi64(_mm256_set1_epi64x((long long) start), _mm256_setr_epi64x(0, 1, 2, 3));
+    __m256i sum = _mm256_setzero_si256();
+    for (size_t block = 0; block < count / 4; block++) {
+        __m256i passed = _mm256_setzero_si256();
+        for (size_t t = 0; t < n_tests; t++) {
+            const __m256i product = _mm256_xor_si256(mullo64(value, inverse[t]), flip);
+            passed = _mm256_or_si256(passed, _mm256_cmpgt_epi64(bound[t], product));
+        }
+        sum = _mm256_add_epi64(sum, _mm256_and_si256(value, passed));
+        value = _mm256_add_epi64(value, step);
+    }
+
+    size_t lanes[4];
+    _mm256_storeu_si256((__m256i*) lanes, sum);
+    const size_t tail = count % 4;
+    return lanes[0] + lanes[1] + lanes[2] + lanes[3] + (tail ? checkedSumScalar(end - tail + 1, end, tests, n_tests) : 0);
+}
+
+#endif
+
+static size_t batchedSum(const Range range, const bool any_repeat) {
+    size_t sum = 0;
+    for (size_t length = digitCount(range.start); length <= MAX_DIGITS; length++) {
+        const size_t first = POW10[length - 1];
+        const size_t last = length < MAX_DIGITS ? POW10[length] - 1 : SIZE_MAX;
+        if (range.end < first) {
+            break;
+        }
+        const size_t start = range.start > first ? range.start : first;
+        const size_t end = range.end < last ? range.end : last;
+
+        const RepeatTests* tests = &repeat_tests[length];
+        const DivisorTest* tested = any_repeat ? tests->any : tests->once;
+        const size_t n_tests = any_repeat ? tests->n_any : tests->n_once;
+        if (!n_tests) {
+            continue;
+        }
+#if defined(__x86_64__) || defined(__i386__)
+        if (scan_isa() == SCAN_AVX2) {
+            sum += checkedSumAvx2(start, end, tested, n_tests);
+            continue;
+        }
+#endif
+        sum += checkedSumScalar(start, end, tested, n_tests);
+    }
+    return sum;
+}
+
+static size_t batchedPart1(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->n; i++) {
+        sum += batchedSum(d->ranges[i], false);
+    }
+    return sum;
+}
+
+static size_t batchedPart2(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->n; i++) {
+        sum += batchedSum(d->ranges[i], true);
+    }
+    return sum;
+}
+
+static void freeData(const Data* data) {
+    free(data->ranges);
+}
+
+// Parallel: range widths differ by orders of magnitude, so parse cuts the ranges into pieces of
+// about the same width (a few per thread in total) and each part hands the pieces out one at a
+// time through aoc_parallel_for's shared counter. With pieces of equal cost, one shared queue
+// balances as well as per-thread queues with stealing would. The piece sums are added up once
+// all pieces are done.
+typedef struct {
+    const Data* pieces;
+    bool any_repeat;
+    size_t* sums;
+} Pieces;
+
+static void sumPiece(const size_t i, void* ctx) {
+    const Pieces* pieces = ctx;
+    pieces->sums[i] = batchedSum(pieces->pieces->ranges[i], pieces->any_repeat);
+}
+
+static size_t sumPiecesParallel(const Data* pieces, const bool any_repeat) {
+    size_t* sums = malloc(sizeof(size_t) * (pieces->n ? pieces->n : 1));
+    if (!sums) {
+        perror("Out of memory.");
+        return 0;
+    }
+
+    Pieces work = { .pieces = pieces, .any_repeat = any_repeat, .sums = sums };
+    aoc_parallel_for(pieces->n, aoc_threads(), sumPiece, &work);
+
+    size_t sum = 0;
+    for (size_t i = 0; i < pieces->n; i++) {
+        sum += sums[i];
+    }
+    free(sums);
+    return sum;
+}
+
+// the ranges cut into pieces, which are ranges themselves
+static Data parsePiecesFile(const char* path) {
+    const Data data = parseFile(path);
+    if (!data.parse_successful) {
+        goto error;
+    }
+
+    // widths saturate rather than wrap, a range can span nearly all of 2^64
+    size_t total = 0;
+    for (size_t i = 0; i < data.n; i++) {
+        const size_t width = data.ranges[i].end - data.ranges[i].start;
+        total = total + width < total ? SIZE_MAX : total + width;
+    }
+
+    const size_t min_piece = 1 << 16;
+    size_t piece = total / (aoc_threads() * 8);
+    piece = piece < min_piece ? min_piece : piece;
+
+    size_t n_pieces = 0;
+    for (size_t i = 0; i < data.n; i++) {
+        if (data.ranges[i].start <= data.ranges[i].end) {
+            n_pieces += (data.ranges[i].end - data.ranges[i].start) / piece + 1;
+        }
+    }
+
+    Range* pieces = malloc(sizeof(Range) * (n_pieces ? n_pieces : 1));
+    if (!pieces) {
+        perror("Out of memory.");
+        freeData(&data);
+        goto error;
+    }
+
+    size_t n = 0;
+    for (size_t i = 0; i < data.n; i++) {
+        const Range r = data.ranges[i];
+        for (size_t start = r.start; start <= r.end; start += piece) {
+            pieces[n++] = (Range) { start, r.end - start < piece ? r.end : start + piece - 1 };
+            if (r.end - start < piece) {
+                break;
+            }
+        }
+    }
+    freeData(&data);
+
+    return (Data) { pieces, n, true };
+error:
+    return (Data) { NULL, 0, false };
+}
+
+static void* parseParallel(const char* path) {
+    const Data pieces = parsePiecesFile(path);
+    if (!pieces.parse_successful) {
+        return NULL;
+    }
+
+    Data* boxed = aoc_box(&pieces, sizeof(pieces));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&pieces);
+    }
+    return boxed;
+}
+
+static size_t parallelPart1(const void* data) {
+    return sumPiecesParallel(data, false);
+}
+
+static size_t parallelPart2(const void* data) {
+    return sumPiecesParallel(data, true);
+}
+
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
     }
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
+    }
+    return boxed;
+}
+
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
+
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// `size` ranges on one line; starts and widths are spread over several orders of magnitude like the puzzle's
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    Rng rng = rng_seed(seed);
+    for (size_t i = 0; i < size; i++) {
+        uint64_t max_start = 1, max_width = 1;
+        for (uint64_t d = rng_range(&rng, 1, 10); d > 0; d--) {
+            max_start *= 10;
+        }
+        for (uint64_t d = rng_range(&rng, 1, 5); d > 0; d--) {
+            max_width *= 10;
+        }
+
+        const uint64_t start = rng_range(&rng, 1, max_start);
+        const uint64_t end = start + rng_range(&rng, 0, max_width);
+        fprintf(out, "%s%" PRIu64 "-%" PRIu64, i ? "," : "", start, end);
+    }
+    fprintf(out, "\n");
+    return !ferror(out);
+}
+
+static const AocVariant VARIANTS[] = {
+    { .name = "closed", .part1 = closedFormPart1, .part2 = closedFormPart2 },
+    { .name = "indexed", .part1 = indexedPart1, .part2 = indexedPart2 },
+    { .name = "arithmetic", .part1 = arithmeticPart1, .part2 = arithmeticPart2 },
+    { .name = "batched", .part1 = batchedPart1, .part2 = batchedPart2 },
+    { .name = "parallel", .part1 = parallelPart1, .part2 = parallelPart2, .parse = parseParallel, .release = release },
+};
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+const AocDay day02 = {
+    .name = "day02",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+    .variants = VARIANTS,
+    .n_variants = sizeof(VARIANTS) / sizeof(*VARIANTS),
+};
 
-    free(data.ranges);
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day02, argc, argv);
 }
+#endif
@@ -1,9 +1,19 @@
-#include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+#include "aoc.h"
+#include "digits.h"
+#include "input.h"
+#include "parallel.h"
+#include "rng.h"
+#include "scan.h"
+
 typedef unsigned char byte;
 
 typedef struct {
@@ -13,49 +23,50 @@ typedef struct {
     const bool parse_successful;
 } Data;
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
         goto error;
     }
 
-    byte* data = NULL;
-    char* line = NULL;
-    size_t rows = 0, cols = 0, len;
-    while (getline(&line, &len, fp) > 0) {
-        len = strlen(line);
-        if (line[len - 1] == '\n') {
-            len--;
-            if (!cols) {
-                cols = len;
-            }
-        }
-        byte* new = realloc(data, sizeof(byte) * (rows + 1) * cols);
-        if (!new) {
-            perror("Out of memory");
-            free(data);
-            free(line);
-            fclose(fp);
-            goto error;
-        }
-        data = new;
+    Line* lines;
+    size_t n_lines;
+    if (!input_lines(&input, &lines, &n_lines)) {
+        input_close(&input);
+        goto error;
+    }
+
+    // every bank has as many batteries as the first one, so the grid is allocated exactly once
+    const size_t cols = n_lines ? lines[0].len : 0;
+    size_t rows = 0;
+    while (rows < n_lines && lines[rows].len) {
+        rows++;
+    }
+
+    byte* data = malloc(sizeof(byte) * (rows * cols > 0 ? rows * cols : 1));
+    if (!data) {
+        perror("Out of memory");
+        free(lines);
+        input_close(&input);
+        goto error;
+    }
 
+    for (size_t i = 0; i < rows; i++) {
+        const size_t len = lines[i].len < cols ? lines[i].len : cols;
         for (size_t j = 0; j < len; j++) {
-            const byte b = (byte) (line[j] - '0');
-            data[rows*cols + j] = b;
+            const byte b = (byte) (lines[i].str[j] - '0');
+            data[i*cols + j] = b;
         }
-        rows++;
     }
 
-    free(line);
-    fclose(fp);
+    free(lines);
+    input_close(&input);
     return (Data) { data, rows, cols, true };
 error:
     return (Data) { NULL, 0, 0, false };
 }
 
-size_t bestTwo(const byte* batteries, const size_t start, const size_t end) {
+static size_t bestTwo(const byte* batteries, const size_t start, const size_t end) {
     size_t max = 0;
     for (size_t i = start; i < end; i++) {
         for (size_t j = i + 1; j < end; j++) {
@@ -68,7 +79,7 @@ size_t bestTwo(const byte* batteries, const size_t start, const size_t end) {
     return max;
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
     const byte* batteries = data->batteries;
     const size_t rows = data->rows, cols = data->cols;
 
@@ -79,7 +90,7 @@ size_t part1(const Data* data) {
     return sum;
 }
 
-size_t best(const byte* batteries, const size_t start, const size_t end, const size_t depth) {
+static size_t best(const byte* batteries, const size_t start, const size_t end, const size_t depth) {
     size_t left = start;
     size_t curr = 0;
     for (size_t d = depth; d > 0; d--) {
@@ -102,11 +113,11 @@ size_t best(const byte* batteries, const size_t start, const size_t end, const s
     return curr;
 }
 
-size_t bestTwelve(const byte* batteries, const size_t start, const size_t end) {
+static size_t bestTwelve(const byte* batteries, const size_t start, const size_t end) {
     return best(batteries, start, end, 12);
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     const byte* batteries = data->batteries;
     const size_t rows = data->rows, cols = data->cols;
 
@@ -118,19 +129,463 @@ size_t part2(const Data* data) {
     return sum;
 }
 
-int main(void) {
-    const char* path = "inputs/day03.txt";
+static void freeData(const Data* data) {
+    free(data->batteries);
+}
+
+// Stack: both parts from one pass over each row with the monotonic-stack selection in digits.h,
+// O(cols) per row and k instead of O(cols^2) and O(cols * k). Parse only reads the grid; part 1
+// always makes the pass and leaves part 2's sum behind, which part 2 only computes itself when
+// it runs alone.
+enum { PART1_DIGITS = 2, PART2_DIGITS = 12 };
+
+typedef struct {
+    size_t p2;
+    bool solved;
+} StackPart2;
+
+typedef struct {
+    const Data data;
+    StackPart2* part2;
+} Stack;
+
+// both selections' numbers summed over all rows; a row shorter than k adds 0, like `best`
+static size_t stackSolve(const Stack* stack) {
+    const Data* data = &stack->data;
+    byte digits[PART1_DIGITS + PART2_DIGITS];
+    DigitSelection selections[2] = { { digits, PART1_DIGITS, 0 }, { digits + PART1_DIGITS, PART2_DIGITS, 0 } };
+    size_t p1 = 0, p2 = 0;
+    for (size_t i = 0; i < data->rows; i++) {
+        digits_select_many(data->batteries + i * data->cols, data->cols, selections, 2);
+
+        size_t value;
+        p1 += digits_value(&selections[0], &value) ? value : 0;
+        p2 += digits_value(&selections[1], &value) ? value : 0;
+    }
+
+    *stack->part2 = (StackPart2) { p2, true };
+    return p1;
+}
+
+static size_t stackPart1(const void* data) {
+    return stackSolve(data);
+}
+
+static size_t stackPart2(const void* data) {
+    const Stack* stack = data;
+    if (!stack->part2->solved) {
+        stackSolve(stack);
+    }
+    return stack->part2->p2;
+}
+
+static void* parseStack(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
+    }
+
+    StackPart2* part2 = calloc(1, sizeof(StackPart2));
+    const Stack stack = { data, part2 };
+    Stack* boxed = part2 ? aoc_box(&stack, sizeof(stack)) : NULL;
+    if (!boxed) {
+        perror("Out of memory.");
+        free(part2);
+        freeData(&data);
+    }
+    return boxed;
+}
+
+static void releaseStack(void* data) {
+    const Stack* stack = data;
+    freeData(&stack->data);
+    free(stack->part2);
+    free(data);
+}
+
+static void* parse(const char* path) {
+    const Data data = parseFile(path);
+    if (!data.parse_successful) {
+        return NULL;
+    }
+
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
+    }
+    return boxed;
+}
+
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
+
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// `size` banks of 100 batteries each, like the puzzle's
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    Rng rng = rng_seed(seed);
+    char line[101];
+    line[100] = '\n';
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < 100; j++) {
+            line[j] = (char) ('0' + rng_range(&rng, 1, 9));
+        }
+        fwrite(line, 1, sizeof(line), out);
+    }
+    return !ferror(out);
+}
+
+// Window: `best`'s greedy choice with the inner loop as a primitive, the leftmost maximum of a
+// window, found 32 bytes at a time at the AVX2 scanner level: a byte max reduction over the
+// window, then the first position holding that maximum. Part 1 is the same greedy choice for two
+// digits instead of trying every pair.
+static size_t leftmostMaxScalar(const byte* p, const size_t n) {
+    size_t at = 0;
+    for (size_t i = 1; i < n; i++) {
+        if (p[i] > p[at]) {
+            at = i;
+        }
+    }
+    return at;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+__attribute__((target("avx2"))) static size_t leftmostMaxAvx2(const byte* p, const size_t n) {
+    if (n < 32) {
+        return leftmostMaxScalar(p, n);
+    }
+
+    // the last block overlaps the one before instead of leaving a scalar tail
+    __m256i max = _mm256_loadu_si256((const __m256i*) (p + n - 32));
+    for (size_t i = 0; i + 32 < n; i += 32) {
+        max = _mm256_max_epu8(max, _mm256_loadu_si256((const __m256i*) (p + i)));
+    }
+    __m128i half = _mm_max_epu8(_mm256_castsi256_si128(max), _mm256_extracti128_si256(max, 1));
+    half = _mm_max_epu8(half, _mm_srli_si128(half, 8));
+    half = _mm_max_epu8(half, _mm_srli_si128(half, 4));
+    half = _mm_max_epu8(half, _mm_srli_si128(half, 2));
+    half = _mm_max_epu8(half, _mm_srli_si128(half, 1));
+    const __m256i needle = _mm256_broadcastb_epi8(half);
+
+    for (size_t i = 0;; i += 32) {
+        const size_t at = i + 32 <= n ? i : n - 32;
+        const unsigned mask = (unsigned) _mm256_movemask_epi8(_mm256_cmpeq_epi8(_mm256_loadu_si256((const __m256i*) (p + at)), needle));
+        if (mask) {
+            return at + (size_t) __builtin_ctz(mask);
+        }
+    }
+}
+
+#endif
+
+static size_t leftmostMax(const byte* p, const size_t n) {
+#if defined(__x86_64__) || defined(__i386__)
+    if (scan_isa() == SCAN_AVX2) {
+        return leftmostMaxAvx2(p, n);
+    }
+#endif
+    return leftmostMaxScalar(p, n);
+}
+
+// `best` for a single row, with at least `depth` digits left for every later choice
+static size_t bestWindow(const byte* row, const size_t cols, const size_t depth) {
+    if (cols < depth) {
+        return 0;
+    }
+
+    size_t left = 0, curr = 0;
+    for (size_t d = depth; d > 0; d--) {
+        const size_t at = left + leftmostMax(row + left, cols - d - left + 1);
+        curr = curr * 10 + row[at];
+        left = at + 1;
+    }
+    return curr;
+}
+
+static size_t windowPart1(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->rows; i++) {
+        sum += bestWindow(d->batteries + i * d->cols, d->cols, 2);
+    }
+    return sum;
+}
+
+static size_t windowPart2(const void* data) {
+    const Data* d = data;
+    size_t sum = 0;
+    for (size_t i = 0; i < d->rows; i++) {
+        sum += bestWindow(d->batteries + i * d->cols, d->cols, 12);
+    }
+    return sum;
+}
+
+// Parallel: blocks of rows handed to aoc_parallel_for, each summing one part's numbers with the
+// window primitive; the block sums are added up once all blocks are done.
+#define ROW_BLOCK 256
+
+// `-o row_block=N`; aoc_check uses small blocks so that its inputs span several of them
+static size_t row_block = ROW_BLOCK;
+
+static bool configureParallel(const char* option) {
+    if (!option) {
+        row_block = ROW_BLOCK;
+        return true;
+    }
+    return aoc_option_size(option, "row_block", &row_block) && row_block > 0;
+}
+
+static const char* const PARALLEL_CHECKS[] = { "row_block=1", "row_block=3", NULL };
+
+typedef struct {
+    const Data* data;
+    size_t depth;
+    // rows per block
+    size_t rows;
+    size_t* sums;
+} RowBlocks;
+
+static void sumRowBlock(const size_t block, void* ctx) {
+    const RowBlocks* blocks = ctx;
+    const Data* data = blocks->data;
+    const size_t end = (block + 1) * blocks->rows < data->rows ? (block + 1) * blocks->rows : data->rows;
+
+    size_t sum = 0;
+    for (size_t i = block * blocks->rows; i < end; i++) {
+        sum += bestWindow(data->batteries + i * data->cols, data->cols, blocks->depth);
     }
+    blocks->sums[block] = sum;
+}
+
+static size_t sumRowsParallel(const Data* data, const size_t depth) {
+    const size_t n_blocks = (data->rows + row_block - 1) / row_block;
+    size_t* sums = malloc(sizeof(size_t) * (n_blocks ? n_blocks : 1));
+    if (!sums) {
+        perror("Out of memory.");
+        return 0;
+    }
+
+    RowBlocks blocks = { .data = data, .depth = depth, .rows = row_block, .sums = sums };
+    aoc_parallel_for(n_blocks, aoc_threads(), sumRowBlock, &blocks);
+
+    size_t total = 0;
+    for (size_t i = 0; i < n_blocks; i++) {
+        total += sums[i];
+    }
+    free(sums);
+    return total;
+}
+
+static size_t parallelPart1(const void* data) {
+    return sumRowsParallel(data, PART1_DIGITS);
+}
+
+static size_t parallelPart2(const void* data) {
+    return sumRowsParallel(data, PART2_DIGITS);
+}
+
+// Packed: two digits per byte, low nibble first, every row starting on a byte so rows stay
+// independent. The grid is sized once from the file size and the first line's length, without
+// the line array, and the window scan reads the nibbles directly; the AVX2 version widens 16
+// packed bytes into 32 digit bytes per step and masks off the digits outside the window.
+typedef struct {
+    byte* nibbles;
+    const size_t rows;
+    const size_t cols;
+    // bytes per row
+    const size_t stride;
+    const bool parse_successful;
+} Packed;
+
+static Packed parsePackedFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
+    }
+
+    // every bank has as many batteries as the first, so there are at most size / (cols + 1) + 1
+    const char* end = input.data + input.size;
+    const size_t cols = (size_t) (scan_find(input.data, end, '\n') - input.data);
+    const size_t stride = (cols + 1) / 2;
+    const size_t max_rows = input.size / (cols + 1) + 1;
+    // 16 bytes of padding for the vector loads at the end of the last row
+    byte* nibbles = calloc(max_rows * stride + 16, sizeof(byte));
+    if (!nibbles) {
+        perror("Out of memory.");
+        input_close(&input);
+        goto error;
+    }
+
+    size_t rows = 0, pos = 0;
+    Line line;
+    while (rows < max_rows && input_next_line(&input, &pos, &line) && line.len) {
+        byte* row = nibbles + rows * stride;
+        const size_t len = line.len < cols ? line.len : cols;
+        size_t j = 0;
+        for (; j + 1 < len; j += 2) {
+            row[j / 2] = (byte) ((line.str[j] - '0') | (line.str[j + 1] - '0') << 4);
+        }
+        if (j < len) {
+            row[j / 2] = (byte) (line.str[j] - '0');
+        }
+        rows++;
+    }
+
+    input_close(&input);
+    return (Packed) { nibbles, rows, cols, stride, true };
+error:
+    return (Packed) { NULL, 0, 0, 0, false };
+}
+
+static inline byte packedDigit(const byte* row, const size_t i) {
+    return (byte) ((row[i / 2] >> (i % 2 * 4)) & 0x0f);
+}
+
+// leftmost maximum among the digits [from, to) of a packed row
+static size_t leftmostMaxPackedScalar(const byte* row, const size_t from, const size_t to) {
+    size_t at = from;
+    byte max = packedDigit(row, from);
+    for (size_t i = from + 1; i < to; i++) {
+        const byte digit = packedDigit(row, i);
+        if (digit > max) {
+            at = i;
+            max = digit;
+        }
+    }
+    return at;
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// 16 packed bytes as 32 digit bytes, in order
+__attribute__((target("avx2"))) static inline __m256i unpackDigits(const byte* p) {
+    const __m256i wide = _mm256_cvtepu8_epi16(_mm_loadu_si128((const __m128i*) p));
+    return _mm256_or_si256(_mm256_and_si256(wide, _mm256_set1_epi16(0x0f)), _mm256_and_si256(_mm256_slli_epi16(wide, 4), _mm256_set1_epi16(0x0f00)));
+}
+
+// blocks of 32 digits from the even digit at or before `from`; lanes outside [from, to) are
+// masked out, which needs the 16 bytes of padding after the grid for the last block's load
+__attribute__((target("avx2"))) static size_t leftmostMaxPackedAvx2(const byte* row, const size_t from, const size_t to) {
+    const size_t base = from & ~(size_t) 1;
+    const size_t n_blocks = (to - base + 31) / 32;
+    const __m256i lanes = _mm256_setr_epi8(0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15,
+                                           16, 17, 18, 19, 20, 21, 22, 23, 24, 25, 26, 27, 28, 29, 30, 31);
+
+    __m256i vmax = _mm256_setzero_si256();
+    for (size_t b = 0; b < n_blocks; b++) {
+        const size_t start = base + b * 32;
+        const char lo = (char) (from > start ? from - start : 0);
+        const char hi = (char) (to - start < 32 ? to - start : 32);
+        const __m256i valid = _mm256_and_si256(_mm256_cmpgt_epi8(lanes, _mm256_set1_epi8((char) (lo - 1))), _mm256_cmpgt_epi8(_mm256_set1_epi8(hi), lanes));
+        vmax = _mm256_max_epu8(vmax, _mm256_and_si256(unpackDigits(row + start / 2), valid));
+    }
+    __m128i half = _mm_max_epu8(_mm256_castsi256_si128(vmax), _mm256_extracti128_si256(vmax, 1));
+    half = _mm_max_epu8(half, _mm_srli_si128(half, 8));
+    half = _mm_max_epu8(half, _mm_srli_si128(half, 4));
+    half = _mm_max_epu8(half, _mm_srli_si128(half, 2));
+    half = _mm_max_epu8(half, _mm_srli_si128(half, 1));
+    const __m256i needle = _mm256_broadcastb_epi8(half);
+
+    for (size_t b = 0;; b++) {
+        const size_t start = base + b * 32;
+        const char lo = (char) (from > start ? from - start : 0);
+        const __m256i valid = _mm256_cmpgt_epi8(lanes, _mm256_set1_epi8((char) (lo - 1)));
+        const __m256i hit = _mm256_and_si256(_mm256_cmpeq_epi8(unpackDigits(row + start / 2), needle), valid);
+        const unsigned mask = (unsigned) _mm256_movemask_epi8(hit);
+        if (mask) {
+            return start + (size_t) __builtin_ctz(mask);
+        }
+    }
+}
+
+#endif
+
+static size_t bestPacked(const byte* row, const size_t cols, const size_t depth, const bool avx2) {
+    if (cols < depth) {
+        return 0;
+    }
+
+    size_t left = 0, curr = 0;
+    for (size_t d = depth; d > 0; d--) {
+#if defined(__x86_64__) || defined(__i386__)
+        const size_t at = avx2 ? leftmostMaxPackedAvx2(row, left, cols - d + 1) : leftmostMaxPackedScalar(row, left, cols - d + 1);
+#else
+        const size_t at = leftmostMaxPackedScalar(row, left, cols - d + 1);
+        (void) avx2;
+#endif
+        curr = curr * 10 + packedDigit(row, at);
+        left = at + 1;
+    }
+    return curr;
+}
+
+static size_t packedSum(const Packed* packed, const size_t depth) {
+    const bool avx2 = scan_isa() == SCAN_AVX2;
+    size_t sum = 0;
+    for (size_t i = 0; i < packed->rows; i++) {
+        sum += bestPacked(packed->nibbles + i * packed->stride, packed->cols, depth, avx2);
+    }
+    return sum;
+}
+
+static size_t packedPart1(const void* data) {
+    return packedSum(data, 2);
+}
+
+static size_t packedPart2(const void* data) {
+    return packedSum(data, 12);
+}
+
+static void* parsePacked(const char* path) {
+    const Packed packed = parsePackedFile(path);
+    if (!packed.parse_successful) {
+        return NULL;
+    }
+
+    Packed* boxed = aoc_box(&packed, sizeof(packed));
+    if (!boxed) {
+        perror("Out of memory.");
+        free(packed.nibbles);
+    }
+    return boxed;
+}
+
+static void releasePacked(void* data) {
+    free(((Packed*) data)->nibbles);
+    free(data);
+}
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+static const AocVariant VARIANTS[] = {
+    { .name = "stack", .part1 = stackPart1, .part2 = stackPart2, .parse = parseStack, .release = releaseStack },
+    { .name = "window", .part1 = windowPart1, .part2 = windowPart2 },
+    { .name = "parallel", .part1 = parallelPart1, .part2 = parallelPart2,
+      .configure = configureParallel, .options = "row_block=N: rows per block handed to a thread (default 256)", .checks = PARALLEL_CHECKS },
+    { .name = "packed", .part1 = packedPart1, .part2 = packedPart2, .parse = parsePacked, .release = releasePacked },
+};
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+const AocDay day03 = {
+    .name = "day03",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+    .variants = VARIANTS,
+    .n_variants = sizeof(VARIANTS) / sizeof(*VARIANTS),
+};
 
-    free(data.batteries);
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day03, argc, argv);
 }
+#endif
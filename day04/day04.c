@@ -1,9 +1,15 @@
-#include <errno.h>
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aoc.h"
+#include "input.h"
+#include "parallel.h"
+#include "rng.h"
+
 typedef struct {
     bool* grid;
     const size_t rows;
@@ -11,49 +17,49 @@ typedef struct {
     const bool parse_successful;
 } Data;
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
         goto error;
     }
 
-    bool* data = NULL;
-    char* line = NULL;
-    size_t rows = 0, cols = 0, len;
-    while (getline(&line, &len, fp) > 0) {
-        len = strlen(line);
-        if (line[len - 1] == '\n') {
-            len--;
-            if (!cols) {
-                cols = len;
-            }
-        }
-        bool* new = realloc(data, sizeof(bool) * (rows + 1) * cols);
-        if (!new) {
-            perror("Out of memory");
-            free(data);
-            free(line);
-            fclose(fp);
-            goto error;
-        }
-        data = new;
+    Line* lines;
+    size_t n_lines;
+    if (!input_lines(&input, &lines, &n_lines)) {
+        input_close(&input);
+        goto error;
+    }
 
-        for (size_t j = 0; j < len; j++) {
-            const bool b = (bool) (line[j] == '@');
-            data[rows*cols + j] = b;
-        }
+    // all rows are as wide as the first one, so the grid is allocated exactly once
+    const size_t cols = n_lines ? lines[0].len : 0;
+    size_t rows = 0;
+    while (rows < n_lines && lines[rows].len) {
         rows++;
     }
 
-    free(line);
-    fclose(fp);
+    bool* data = malloc(sizeof(bool) * (rows * cols > 0 ? rows * cols : 1));
+    if (!data) {
+        perror("Out of memory");
+        free(lines);
+        input_close(&input);
+        goto error;
+    }
+
+    for (size_t i = 0; i < rows; i++) {
+        for (size_t j = 0; j < cols; j++) {
+            const bool b = (bool) (j < lines[i].len && lines[i].str[j] == '@');
+            data[i*cols + j] = b;
+        }
+    }
+
+    free(lines);
+    input_close(&input);
     return (Data) { data, rows, cols, true };
 error:
     return (Data) { NULL, 0, 0, false };
 }
 
-size_t nAdjacent(const bool* grid, const size_t rows, const size_t cols, const size_t i) {
+static size_t nAdjacent(const bool* grid, const size_t rows, const size_t cols, const size_t i) {
     int left = 0, up_left = 0, up = 0, up_right = 0, right = 0, down_right = 0, down = 0, down_left = 0;
 
     if (i % cols > 0 && grid[i - 1]) {
@@ -84,7 +90,7 @@ size_t nAdjacent(const bool* grid, const size_t rows, const size_t cols, const s
     return (size_t) (left + up_left + up + up_right + right + down_right + down + down_left);
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
     const bool* grid = data->grid;
     const size_t rows = data->rows, cols = data->cols;
 
@@ -97,7 +103,7 @@ size_t part1(const Data* data) {
     return reachable;
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     const bool* grid = data->grid;
     const size_t rows = data->rows, cols = data->cols;
 
@@ -134,19 +140,640 @@ size_t part2(const Data* data) {
     return total_changes;
 }
 
-int main(void) {
-    const char* path = "inputs/day04.txt";
+static void freeData(const Data* data) {
+    free(data->grid);
+}
+
+// Bitboard: one bit per cell, 64 cells of a row per word, column c in bit c % 64 of word c / 64.
+// Every row has a zero word on either side and the grid a zero row above and below, so the
+// neighbour words of any cell exist and cells outside the grid read as empty. The kernel counts
+// the eight neighbours of 64 cells at once by adding shifted words into a bit-sliced counter.
+typedef struct {
+    // (rows + 2) * stride words, row r's cells at words + (r + 1) * stride + 1
+    uint64_t* words;
+    const size_t rows;
+    const size_t cols;
+    const size_t stride;
+    const bool parse_successful;
+} Bitboard;
+
+static Bitboard parseBitboardFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
+    }
+
+    size_t pos = 0;
+    Line line;
+    const size_t cols = input_next_line(&input, &pos, &line) ? line.len : 0;
+    const size_t max_rows = input_count_lines(&input);
+    const size_t stride = (cols + 63) / 64 + 2;
+    uint64_t* words = calloc((max_rows + 2) * stride, sizeof(uint64_t));
+    if (!words) {
+        perror("Out of memory.");
+        input_close(&input);
+        goto error;
+    }
+
+    size_t rows = 0;
+    pos = 0;
+    while (rows < max_rows && input_next_line(&input, &pos, &line) && line.len) {
+        uint64_t* row = words + (rows + 1) * stride + 1;
+        const size_t len = line.len < cols ? line.len : cols;
+        for (size_t w = 0; w * 64 < len; w++) {
+            const char* cells = line.str + w * 64;
+            const size_t n = len - w * 64 < 64 ? len - w * 64 : 64;
+            uint64_t bits = 0;
+            for (size_t j = 0; j < n; j++) {
+                bits |= (uint64_t) (cells[j] == '@') << j;
+            }
+            row[w] = bits;
+        }
+        rows++;
+    }
+
+    input_close(&input);
+    return (Bitboard) { words, rows, cols, stride, true };
+error:
+    return (Bitboard) { NULL, 0, 0, 0, false };
+}
+
+// adds the one-bit plane `x` to a per-bit counter; s2 sticks once a bit has counted to 4
+static inline void addPlane(uint64_t* s0, uint64_t* s1, uint64_t* s2, const uint64_t x) {
+    const uint64_t c0 = *s0 & x;
+    *s0 ^= x;
+    const uint64_t c1 = *s1 & c0;
+    *s1 ^= c0;
+    *s2 |= c1;
+}
+
+// cells of the word at `mid` with fewer than 4 of their 8 neighbours set; `up` and `down` point at
+// the same word one row above and below, and each pointer's neighbours at [-1] and [1] exist
+static inline uint64_t accessibleWord(const uint64_t* up, const uint64_t* mid, const uint64_t* down) {
+    uint64_t s0 = 0, s1 = 0, s2 = 0;
+    const uint64_t* rows[3] = { up, mid, down };
+    for (size_t r = 0; r < 3; r++) {
+        const uint64_t* w = rows[r];
+        // bit c of `left` is column c - 1, bit c of `right` is column c + 1
+        addPlane(&s0, &s1, &s2, w[0] << 1 | w[-1] >> 63);
+        addPlane(&s0, &s1, &s2, w[0] >> 1 | w[1] << 63);
+        if (r != 1) {
+            addPlane(&s0, &s1, &s2, w[0]);
+        }
+    }
+    return mid[0] & ~s2;
+}
+
+static size_t bitboardPart1(const void* data) {
+    const Bitboard* board = data;
+    const size_t words = board->stride - 2;
+
+    size_t reachable = 0;
+    for (size_t r = 0; r < board->rows; r++) {
+        const uint64_t* mid = board->words + (r + 1) * board->stride + 1;
+        for (size_t w = 0; w < words; w++) {
+            reachable += (size_t) __builtin_popcountll(accessibleWord(mid + w - board->stride, mid + w, mid + w + board->stride));
+        }
+    }
+    return reachable;
+}
+
+// Rounds clear accessible cells in place, row by row, instead of from a snapshot of the previous
+// round. That only lets a cell go earlier, when it already had fewer than 4 neighbours, and the
+// cells that can be peeled off in the end don't depend on the order they go in.
+static size_t bitboardPart2(const void* data) {
+    const Bitboard* board = data;
+    const size_t words = board->stride - 2;
+    const size_t size = (board->rows + 2) * board->stride;
+
+    uint64_t* grid = malloc(sizeof(uint64_t) * size);
+    if (!grid) {
+        perror("Out of memory.");
+        return 0;
+    }
+    memcpy(grid, board->words, sizeof(uint64_t) * size);
+
+    size_t removed = 0, n_changes;
+    do {
+        n_changes = 0;
+        for (size_t r = 0; r < board->rows; r++) {
+            uint64_t* mid = grid + (r + 1) * board->stride + 1;
+            for (size_t w = 0; w < words; w++) {
+                const uint64_t accessible = accessibleWord(mid + w - board->stride, mid + w, mid + w + board->stride);
+                mid[w] &= ~accessible;
+                n_changes += (size_t) __builtin_popcountll(accessible);
+            }
+        }
+        removed += n_changes;
+    } while (n_changes > 0);
+
+    free(grid);
+    return removed;
+}
+
+static void* parseBitboard(const char* path) {
+    const Bitboard board = parseBitboardFile(path);
+    if (!board.parse_successful) {
+        return NULL;
+    }
+
+    Bitboard* boxed = aoc_box(&board, sizeof(board));
+    if (!boxed) {
+        perror("Out of memory.");
+        free(board.words);
+    }
+    return boxed;
+}
+
+static void releaseBitboard(void* data) {
+    free(((Bitboard*) data)->words);
+    free(data);
+}
+
+// Bands: part 2 on the bitboard with one row band per thread. A round reads the previous grid and
+// writes the next one, so a band's first and last rows read the neighbouring bands' edge rows
+// (the one-row halo) while nobody writes them. Each thread counts its band's removals; at the
+// barrier one thread adds them up, ends the rounds when nothing changed, and swaps the grids
+// before the next barrier releases everyone into the next round.
+typedef struct {
+    const Bitboard* board;
+    uint64_t* prev;
+    uint64_t* next;
+    size_t* changes;
+    size_t removed;
+    bool done;
+} Bands;
+
+static void peelBand(AocTeam* team, const size_t i, const size_t n, void* ctx) {
+    Bands* bands = ctx;
+    const Bitboard* board = bands->board;
+    const size_t stride = board->stride, words = stride - 2;
+    const size_t first = board->rows * i / n, last = board->rows * (i + 1) / n;
+
+    while (true) {
+        size_t changes = 0;
+        for (size_t r = first; r < last; r++) {
+            const size_t at = (r + 1) * stride + 1;
+            const uint64_t* mid = bands->prev + at;
+            uint64_t* out = bands->next + at;
+            for (size_t w = 0; w < words; w++) {
+                const uint64_t accessible = accessibleWord(mid + w - stride, mid + w, mid + w + stride);
+                out[w] = mid[w] & ~accessible;
+                changes += (size_t) __builtin_popcountll(accessible);
+            }
+        }
+        bands->changes[i] = changes;
+
+        if (aoc_team_barrier(team)) {
+            size_t total = 0;
+            for (size_t t = 0; t < n; t++) {
+                total += bands->changes[t];
+            }
+            bands->removed += total;
+            bands->done = total == 0;
+
+            uint64_t* swap = bands->prev;
+            bands->prev = bands->next;
+            bands->next = swap;
+        }
+        aoc_team_barrier(team);
+        if (bands->done) {
+            return;
+        }
+    }
+}
+
+static size_t bandsPart2(const void* data) {
+    const Bitboard* board = data;
+    const size_t size = (board->rows + 2) * board->stride;
+    size_t threads = aoc_threads();
+    threads = threads < board->rows ? threads : (board->rows ? board->rows : 1);
+
+    // both grids keep the zero border, only the cells are ever written
+    uint64_t* prev = malloc(sizeof(uint64_t) * size);
+    uint64_t* next = malloc(sizeof(uint64_t) * size);
+    size_t* changes = malloc(sizeof(size_t) * threads);
+    if (!prev || !next || !changes) {
+        perror("Out of memory.");
+        free(prev);
+        free(next);
+        free(changes);
+        return 0;
+    }
+    memcpy(prev, board->words, sizeof(uint64_t) * size);
+    memcpy(next, board->words, sizeof(uint64_t) * size);
+
+    Bands bands = { .board = board, .prev = prev, .next = next, .changes = changes, .removed = 0, .done = false };
+    aoc_parallel_team(threads, peelBand, &bands);
+
+    free(prev);
+    free(next);
+    free(changes);
+    return bands.removed;
+}
+
+// Worklist: part 2 as a peeling process instead of rounds. Every roll knows how many of its
+// neighbours are rolls; the ones below 4 start in a queue, and removing a roll decrements its
+// eight neighbours and queues those that just dropped from 4 to 3. Counts only ever go down, so
+// a roll is queued at most once and the work is proportional to the removals, not to rounds
+// times cells. The counts live on a grid with a one-cell border so neighbours need no checks.
+static size_t worklistPart2(const void* data) {
+    const Data* d = data;
+    const size_t width = d->cols + 2;
+    const size_t cells = (d->rows + 2) * width;
+
+    unsigned char* counts = calloc(cells, sizeof(unsigned char));
+    bool* rolls = calloc(cells, sizeof(bool));
+    size_t* queue = malloc(sizeof(size_t) * (d->rows * d->cols > 0 ? d->rows * d->cols : 1));
+    if (!counts || !rolls || !queue) {
+        perror("Out of memory.");
+        free(counts);
+        free(rolls);
+        free(queue);
+        return 0;
+    }
+
+    const ptrdiff_t w = (ptrdiff_t) width;
+    const ptrdiff_t neighbours[8] = { -w - 1, -w, -w + 1, -1, 1, w - 1, w, w + 1 };
+    for (size_t r = 0; r < d->rows; r++) {
+        for (size_t c = 0; c < d->cols; c++) {
+            rolls[(r + 1) * width + c + 1] = d->grid[r * d->cols + c];
+        }
+    }
+
+    size_t head = 0, tail = 0;
+    for (size_t i = width; i < cells - width; i++) {
+        if (!rolls[i]) {
+            continue;
+        }
+        unsigned char count = 0;
+        for (size_t n = 0; n < 8; n++) {
+            count += rolls[(size_t) ((ptrdiff_t) i + neighbours[n])];
+        }
+        counts[i] = count;
+        if (count < 4) {
+            queue[tail++] = i;
+        }
+    }
+
+    // removed rolls stay marked in `rolls`, their counts are below 4 already so they can't be queued again
+    while (head < tail) {
+        const size_t i = queue[head++];
+        for (size_t n = 0; n < 8; n++) {
+            const size_t j = (size_t) ((ptrdiff_t) i + neighbours[n]);
+            if (rolls[j] && --counts[j] == 3) {
+                queue[tail++] = j;
+            }
+        }
+    }
+
+    free(counts);
+    free(rolls);
+    free(queue);
+    return tail;
+}
+
+// Grid: the same accessibility analysis for other neighbourhoods and thresholds, selected with
+// `-o neighbourhood=...` and `-o threshold=...` for the grid variant. The combinations in
+// GRID_KERNELS get a sweep of their own with both as constants, so the neighbour loop unrolls into
+// straight-line adds over the columns and vectorizes; any other combination runs the same code
+// with them as parameters. Cells are bytes in a grid with a GRID_PAD wide empty border, enough
+// for every neighbourhood, and rounds go from one grid to the other like the reference's.
+#define GRID_PAD 2
+
+static const signed char NEIGHBOURS_moore[][2] = {
+    { -1, -1 }, { -1, 0 }, { -1, 1 }, { 0, -1 }, { 0, 1 }, { 1, -1 }, { 1, 0 }, { 1, 1 },
+};
+
+static const signed char NEIGHBOURS_vonneumann[][2] = {
+    { -1, 0 }, { 0, -1 }, { 0, 1 }, { 1, 0 },
+};
+
+// the 5 x 5 square around the cell
+static const signed char NEIGHBOURS_radius2[][2] = {
+    { -2, -2 }, { -2, -1 }, { -2, 0 }, { -2, 1 }, { -2, 2 },
+    { -1, -2 }, { -1, -1 }, { -1, 0 }, { -1, 1 }, { -1, 2 },
+    { 0, -2 }, { 0, -1 }, { 0, 1 }, { 0, 2 },
+    { 1, -2 }, { 1, -1 }, { 1, 0 }, { 1, 1 }, { 1, 2 },
+    { 2, -2 }, { 2, -1 }, { 2, 0 }, { 2, 1 }, { 2, 2 },
+};
+
+typedef struct {
+    const char* name;
+    const signed char (*offsets)[2];
+    size_t n;
+} Neighbourhood;
+
+#define NEIGHBOURHOOD(hood) { #hood, NEIGHBOURS_##hood, sizeof(NEIGHBOURS_##hood) / sizeof(*NEIGHBOURS_##hood) }
+
+static const Neighbourhood NEIGHBOURHOODS[] = {
+    NEIGHBOURHOOD(moore),
+    NEIGHBOURHOOD(vonneumann),
+    NEIGHBOURHOOD(radius2),
+};
+
+// set with `-o`; `grid_generic` keeps the generic sweep even where there is a specialised kernel
+static const Neighbourhood* grid_neighbourhood = &NEIGHBOURHOODS[0];
+static size_t grid_threshold = 4;
+static bool grid_generic = false;
+
+typedef struct {
+    // (rows + 2 * GRID_PAD) * width cells, 1 for a roll
+    unsigned char* cells;
+    const size_t rows;
+    const size_t cols;
+    const size_t width;
+    const bool parse_successful;
+} Grid;
+
+static Grid parseGridFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
+    }
+
+    size_t pos = 0;
+    Line line;
+    const size_t cols = input_next_line(&input, &pos, &line) ? line.len : 0;
+    const size_t max_rows = input_count_lines(&input);
+    const size_t width = cols + 2 * GRID_PAD;
+    unsigned char* cells = calloc((max_rows + 2 * GRID_PAD) * width, sizeof(unsigned char));
+    if (!cells) {
+        perror("Out of memory.");
+        input_close(&input);
+        goto error;
+    }
+
+    size_t rows = 0;
+    pos = 0;
+    while (rows < max_rows && input_next_line(&input, &pos, &line) && line.len) {
+        unsigned char* row = cells + (rows + GRID_PAD) * width + GRID_PAD;
+        const size_t len = line.len < cols ? line.len : cols;
+        for (size_t j = 0; j < len; j++) {
+            row[j] = line.str[j] == '@';
+        }
+        rows++;
+    }
+
+    input_close(&input);
+    return (Grid) { cells, rows, cols, width, true };
+error:
+    return (Grid) { NULL, 0, 0, 0, false };
+}
+
+// writes `in` without its accessible rolls to `out` and returns how many there were; always
+// inlined so that the specialised sweeps see their neighbourhood and threshold as constants
+__attribute__((always_inline)) static inline size_t sweepGrid(const Grid* grid, const unsigned char* restrict in, unsigned char* restrict out,
+                                                             const signed char (*offsets)[2], const size_t n, const size_t threshold) {
+    // locals, so that the stores to `out` can't be taken for changes to the shape
+    const size_t rows = grid->rows, cols = grid->cols;
+    const ptrdiff_t width = (ptrdiff_t) grid->width;
+    size_t changes = 0;
+    for (size_t r = 0; r < rows; r++) {
+        const size_t at = (r + GRID_PAD) * (size_t) width + GRID_PAD;
+        const unsigned char* row = in + at;
+        unsigned char* dst = out + at;
+
+        // byte lanes throughout: at most 24 neighbours, and a row's changes are summed in 32 bits
+        unsigned row_changes = 0;
+        for (size_t c = 0; c < cols; c++) {
+            // neighbours as signed offsets from the cell pointer, which keeps the addresses affine in `c`
+            const unsigned char* cell = &row[c];
+            unsigned char count = 0;
+#pragma GCC unroll 24
+            for (size_t k = 0; k < n; k++) {
+                count = (unsigned char) (count + cell[offsets[k][0] * width + offsets[k][1]]);
+            }
+            const unsigned char removed = *cell & (count < threshold);
+            dst[c] = *cell ^ removed;
+            row_changes += removed;
+        }
+        changes += row_changes;
+    }
+    return changes;
+}
+
+#define GRID_KERNELS(X) \
+    X(moore, 3)         \
+    X(moore, 4)         \
+    X(moore, 5)         \
+    X(vonneumann, 2)    \
+    X(vonneumann, 3)    \
+    X(radius2, 8)       \
+    X(radius2, 12)
+
+#define GRID_SWEEP(hood, threshold)                                                                   \
+    static size_t sweep_##hood##_##threshold(const Grid* grid, const unsigned char* restrict in, unsigned char* restrict out) { \
+        return sweepGrid(grid, in, out, NEIGHBOURS_##hood, sizeof(NEIGHBOURS_##hood) / sizeof(*NEIGHBOURS_##hood), threshold); \
+    }
+
+GRID_KERNELS(GRID_SWEEP)
+
+typedef struct {
+    const char* neighbourhood;
+    size_t threshold;
+    size_t (*sweep)(const Grid* grid, const unsigned char* in, unsigned char* out);
+} GridKernel;
+
+#define GRID_KERNEL(hood, threshold) { #hood, threshold, sweep_##hood##_##threshold },
+
+static const GridKernel GRID_KERNEL_TABLE[] = {
+    GRID_KERNELS(GRID_KERNEL)
+};
+
+static size_t sweepSelected(const Grid* grid, const unsigned char* in, unsigned char* out) {
+    for (size_t i = 0; !grid_generic && i < sizeof(GRID_KERNEL_TABLE) / sizeof(*GRID_KERNEL_TABLE); i++) {
+        const GridKernel* kernel = &GRID_KERNEL_TABLE[i];
+        if (kernel->threshold == grid_threshold && strcmp(kernel->neighbourhood, grid_neighbourhood->name) == 0) {
+            return kernel->sweep(grid, in, out);
+        }
+    }
+    return sweepGrid(grid, in, out, grid_neighbourhood->offsets, grid_neighbourhood->n, grid_threshold);
+}
+
+static size_t gridPart1(const void* data) {
+    const Grid* grid = data;
+    const size_t size = (grid->rows + 2 * GRID_PAD) * grid->width;
+    unsigned char* out = malloc(size ? size : 1);
+    if (!out) {
+        perror("Out of memory.");
+        return 0;
+    }
+
+    const size_t reachable = sweepSelected(grid, grid->cells, out);
+    free(out);
+    return reachable;
+}
+
+static size_t gridPart2(const void* data) {
+    const Grid* grid = data;
+    const size_t size = (grid->rows + 2 * GRID_PAD) * grid->width;
+    unsigned char* prev = malloc(size ? size : 1);
+    unsigned char* next = malloc(size ? size : 1);
+    if (!prev || !next) {
+        perror("Out of memory.");
+        free(prev);
+        free(next);
+        return 0;
+    }
+    // both keep the empty border, only cells inside the grid are written
+    memcpy(prev, grid->cells, size);
+    memcpy(next, grid->cells, size);
+
+    size_t removed = 0, n_changes;
+    do {
+        n_changes = sweepSelected(grid, prev, next);
+        removed += n_changes;
+
+        unsigned char* swap = prev;
+        prev = next;
+        next = swap;
+    } while (n_changes > 0);
+
+    free(prev);
+    free(next);
+    return removed;
+}
+
+static void* parseGrid(const char* path) {
+    const Grid grid = parseGridFile(path);
+    if (!grid.parse_successful) {
+        return NULL;
+    }
+
+    Grid* boxed = aoc_box(&grid, sizeof(grid));
+    if (!boxed) {
+        perror("Out of memory.");
+        free(grid.cells);
+    }
+    return boxed;
+}
+
+static void releaseGrid(void* data) {
+    free(((Grid*) data)->cells);
+    free(data);
+}
+
+static bool configureGrid(const char* option) {
+    if (!option) {
+        grid_neighbourhood = &NEIGHBOURHOODS[0];
+        grid_threshold = 4;
+        grid_generic = false;
+        return true;
+    }
+
+    const char* value = strchr(option, '=');
+    if (!value) {
+        return false;
+    }
+    const size_t key_len = (size_t) (value++ - option);
+
+    if (key_len == strlen("neighbourhood") && strncmp(option, "neighbourhood", key_len) == 0) {
+        for (size_t i = 0; i < sizeof(NEIGHBOURHOODS) / sizeof(*NEIGHBOURHOODS); i++) {
+            if (strcmp(value, NEIGHBOURHOODS[i].name) == 0) {
+                grid_neighbourhood = &NEIGHBOURHOODS[i];
+                return true;
+            }
+        }
+        return false;
+    }
+    if (key_len == strlen("threshold") && strncmp(option, "threshold", key_len) == 0) {
+        char* end;
+        const unsigned long threshold = strtoul(value, &end, 10);
+        if (*value && !*end) {
+            grid_threshold = (size_t) threshold;
+            return true;
+        }
+        return false;
+    }
+    if (key_len == strlen("kernel") && strncmp(option, "kernel", key_len) == 0) {
+        grid_generic = strcmp(value, "generic") == 0;
+        return grid_generic || strcmp(value, "specialised") == 0;
+    }
+    return false;
+}
+
+// every specialised kernel, checked against the generic sweep with the same parameters
+#define GRID_CHECK(hood, threshold) "neighbourhood=" #hood " threshold=" #threshold,
+
+static const char* const GRID_CHECKS[] = {
+    GRID_KERNELS(GRID_CHECK)
+    NULL,
+};
+
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
+    }
+
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
     }
+    return boxed;
+}
+
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
+
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// a `size` x `size` grid with roughly the puzzle's density of rolls
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    char* line = malloc(size + 1);
+    if (!line) {
+        perror("Out of memory.");
+        return false;
+    }
+
+    Rng rng = rng_seed(seed);
+    line[size] = '\n';
+    for (size_t i = 0; i < size; i++) {
+        for (size_t j = 0; j < size; j++) {
+            line[j] = rng_chance(&rng, 65) ? '@' : '.';
+        }
+        fwrite(line, 1, size + 1, out);
+    }
+
+    free(line);
+    return !ferror(out);
+}
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+static const AocVariant VARIANTS[] = {
+    { .name = "bitboard", .part1 = bitboardPart1, .part2 = bitboardPart2, .parse = parseBitboard, .release = releaseBitboard },
+    { .name = "worklist", .part2 = worklistPart2 },
+    { .name = "bands", .part1 = bitboardPart1, .part2 = bandsPart2, .parse = parseBitboard, .release = releaseBitboard },
+    { .name = "grid", .part1 = gridPart1, .part2 = gridPart2, .parse = parseGrid, .release = releaseGrid,
+      .configure = configureGrid,
+      .options = "neighbourhood=moore|vonneumann|radius2 and threshold=N: rolls with fewer than N rolls in\n"
+                 "      their neighbourhood are accessible (default moore and 4); moore 3-5, vonneumann 2-3 and radius2\n"
+                 "      8 and 12 have specialised kernels, kernel=generic uses the generic sweep for those too",
+      .checks = GRID_CHECKS, .check_against = "kernel=generic" },
+};
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+const AocDay day04 = {
+    .name = "day04",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+    .variants = VARIANTS,
+    .n_variants = sizeof(VARIANTS) / sizeof(*VARIANTS),
+};
 
-    free(data.grid);
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day04, argc, argv);
 }
+#endif
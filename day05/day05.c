@@ -1,9 +1,14 @@
-#include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aoc.h"
+#include "input.h"
+#include "rng.h"
+#include "scan.h"
+
 typedef struct {
     size_t start;
     size_t end_inclusive;
@@ -17,76 +22,64 @@ typedef struct {
     const bool parse_successful;
 } Data;
 
-size_t parseInt(const char* line, const size_t start, const size_t end) {
-    size_t num = 0;
-    for (size_t i = start; i < end; i++) {
-        num = num * 10 + (size_t) (line[i] - '0');
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
     }
-    return num;
-}
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+    // count both sections first so that each array is allocated exactly once
+    size_t n_ranges = 0, n_ingredients = 0, pos = 0;
+    Line line;
+    while (input_next_line(&input, &pos, &line) && line.len) {
+        n_ranges++;
+    }
+    while (input_next_line(&input, &pos, &line)) {
+        n_ingredients += line.len > 0;
+    }
+
+    Range* ranges = malloc(sizeof(Range) * (n_ranges ? n_ranges : 1));
+    size_t* ingredients = malloc(sizeof(size_t) * (n_ingredients ? n_ingredients : 1));
+    if (!ranges || !ingredients) {
+        perror("Out of memory");
+        free(ranges);
+        free(ingredients);
+        input_close(&input);
         goto error;
     }
 
-    Range* ranges = NULL;
-    char* line = NULL;
-    size_t n_ranges = 0, len;
-    while (getline(&line, &len, fp) > 0 && line[0] != '\n') {
-        size_t sep_i = 0;
-        while ('0' <= line[sep_i] && line[sep_i] <= '9') {
-            sep_i++;
-        }
-        const size_t first = parseInt(line, 0, sep_i);
+    // numbers may be read past the end of their line, the digit run stops at the '\n' anyway
+    const char* end = input.data + input.size;
+    pos = 0;
+    for (size_t r = 0; r < n_ranges; r++) {
+        input_next_line(&input, &pos, &line);
 
-        const size_t start_second = ++sep_i;
-        while ('0' <= line[sep_i] && line[sep_i] <= '9') {
-            sep_i++;
-        }
-        const size_t second = parseInt(line, start_second, sep_i);
-
-        Range* new = realloc(ranges, sizeof(Range) * (n_ranges + 1));
-        if (!new) {
-            perror("Out of memory");
-        error_1:
-            free(line);
-            free(ranges);
-            fclose(fp);
-            goto error;
-        }
-        ranges = new;
-        ranges[n_ranges++] = (Range) { first, second };
+        size_t first, second;
+        const char* sep = scan_uint(line.str, end, &first);
+        scan_uint(sep + 1, end, &second);
+
+        ranges[r] = (Range) { first, second };
     }
 
-    size_t n_ingredients = 0;
-    size_t* ingredients = NULL;
-    while (getline(&line, &len, fp) > 0) {
-        size_t i = 0;
-        while ('0' <= line[i] && line[i] <= '9') {
-            i++;
-        }
-        const size_t ing = parseInt(line, 0, i);
+    // skip the blank line between the sections
+    input_next_line(&input, &pos, &line);
 
-        size_t* new = realloc(ingredients, sizeof(size_t) * (n_ingredients + 1));
-        if (!new) {
-            free(ingredients);
-            goto error_1;
+    size_t n = 0;
+    while (n < n_ingredients && input_next_line(&input, &pos, &line)) {
+        if (!line.len) {
+            continue;
         }
-        ingredients = new;
-        ingredients[n_ingredients++] = ing;
+
+        scan_uint(line.str, end, &ingredients[n++]);
     }
 
-    free(line);
-    fclose(fp);
+    input_close(&input);
     return (Data) { ranges, n_ranges, ingredients, n_ingredients, true };
 error:
     return (Data) { NULL, 0, NULL, 0, false };
 }
 
-bool isFresh(const Range* fresh, const size_t n, const size_t ingredient) {
+static bool isFresh(const Range* fresh, const size_t n, const size_t ingredient) {
     for (size_t i = 0; i < n; i++) {
         if (fresh[i].start <= ingredient && ingredient <= fresh[i].end_inclusive) {
             return true;
@@ -95,7 +88,7 @@ bool isFresh(const Range* fresh, const size_t n, const size_t ingredient) {
     return false;
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
     const Range* fresh = data->fresh;
     const size_t* ingredients = data->ingredients;
     const size_t n_fresh = data->n_fresh, n_ingredients = data->n_ingredients;
@@ -110,7 +103,7 @@ size_t part1(const Data* data) {
     return n_valid;
 }
 
-int compare(const void* a, const void* b) {
+static int compare(const void* a, const void* b) {
     const size_t a_start = ((const Range*) a)->start;
     const size_t b_start = ((const Range*) b)->start;
 
@@ -119,28 +112,16 @@ int compare(const void* a, const void* b) {
     return 0;
 }
 
-size_t part2(const Data* data) {
-    const Range* fresh = data->fresh;
-    const size_t n_fresh = data->n_fresh;
-
-    Range* sorted = malloc(sizeof(Range) * n_fresh);
-    if (!sorted) {
-        perror("Out of memory.");
-        return 0;
-    }
-    Range* canonical = malloc(sizeof(Range) * n_fresh);
-    if (!canonical) {
-        perror("Out of memory.");
-        free(sorted);
+// merges ranges sorted by start into `canonical`, which may be `sorted` itself, and returns how
+// many disjoint ranges are left; ranges that overlap or touch become one
+static size_t mergeSorted(const Range* sorted, const size_t n, Range* canonical) {
+    if (!n) {
         return 0;
     }
-    memcpy(sorted, fresh, sizeof(Range) * n_fresh);
-
-    qsort(sorted, n_fresh, sizeof(Range), compare);
 
     size_t c = 0;
     canonical[c] = sorted[c];
-    for (size_t i = 1; i < n_fresh; i++) {
+    for (size_t i = 1; i < n; i++) {
         const Range* curr = &sorted[i];
         Range* can = &canonical[c];
 
@@ -159,10 +140,33 @@ size_t part2(const Data* data) {
             canonical[++c] = *curr;
         }
     }
+    return c + 1;
+}
+
+static size_t part2(const Data* data) {
+    const Range* fresh = data->fresh;
+    const size_t n_fresh = data->n_fresh;
+
+    Range* sorted = malloc(sizeof(Range) * n_fresh);
+    if (!sorted) {
+        perror("Out of memory.");
+        return 0;
+    }
+    Range* canonical = malloc(sizeof(Range) * n_fresh);
+    if (!canonical) {
+        perror("Out of memory.");
+        free(sorted);
+        return 0;
+    }
+    memcpy(sorted, fresh, sizeof(Range) * n_fresh);
+
+    qsort(sorted, n_fresh, sizeof(Range), compare);
+
+    const size_t n_canonical = mergeSorted(sorted, n_fresh, canonical);
     free(sorted);
 
     size_t total_valid = 0;
-    for (size_t i = 0; i <= c; i++) {
+    for (size_t i = 0; i < n_canonical; i++) {
         const Range can = canonical[i];
         total_valid += can.end_inclusive - can.start + 1;
     }
@@ -171,20 +175,170 @@ size_t part2(const Data* data) {
     return total_valid;
 }
 
-int main(void) {
-    const char* path = "inputs/day05.txt";
+static void freeData(const Data* data) {
+    free(data->fresh);
+    free(data->ingredients);
+}
+
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
     }
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
+    }
+    return boxed;
+}
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
 
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// Index: the fresh ranges sorted and merged once, at parse time, into disjoint ascending ranges
+// kept as separate start and end arrays. Part 1 looks each ingredient up with a binary search
+// over the starts, O(log ranges) instead of a scan over all of them, and part 2 is the sum of
+// the merged lengths.
+typedef struct {
+    // ascending and disjoint, range i is starts[i] to ends[i] inclusive; one allocation at `starts`
+    size_t* starts;
+    size_t* ends;
+    const size_t n;
+    size_t* ingredients;
+    const size_t n_ingredients;
+    const bool parse_successful;
+} Index;
+
+static Index buildIndex(const char* path) {
+    const Data data = parseFile(path);
+    if (!data.parse_successful) {
+        goto error;
+    }
+
+    // merging in place only ever writes behind the range being read
+    qsort(data.fresh, data.n_fresh, sizeof(Range), compare);
+    const size_t n = mergeSorted(data.fresh, data.n_fresh, data.fresh);
+
+    size_t* starts = malloc(sizeof(size_t) * (n ? 2 * n : 1));
+    if (!starts) {
+        perror("Out of memory.");
+        freeData(&data);
+        goto error;
+    }
+    size_t* ends = starts + n;
+    for (size_t i = 0; i < n; i++) {
+        starts[i] = data.fresh[i].start;
+        ends[i] = data.fresh[i].end_inclusive;
+    }
     free(data.fresh);
-    free(data.ingredients);
+
+    return (Index) { starts, ends, n, data.ingredients, data.n_ingredients, true };
+error:
+    return (Index) { NULL, NULL, 0, NULL, 0, false };
+}
+
+// Halves the candidates without a branch on the comparison, so the loop runs exactly
+// log2(n) times whatever the ids and compiles to conditional moves. `base` ends on the last
+// start at or below the ingredient, if there is one, and only that range can hold it.
+static bool isIndexed(const Index* index, const size_t ingredient) {
+    if (!index->n) {
+        return false;
+    }
+
+    const size_t* base = index->starts;
+    for (size_t len = index->n; len > 1; len -= len / 2) {
+        base = base[len / 2] <= ingredient ? base + len / 2 : base;
+    }
+    return *base <= ingredient && ingredient <= index->ends[base - index->starts];
+}
+
+static size_t indexPart1(const void* data) {
+    const Index* index = data;
+
+    size_t n_valid = 0;
+    for (size_t i = 0; i < index->n_ingredients; i++) {
+        n_valid += isIndexed(index, index->ingredients[i]);
+    }
+    return n_valid;
+}
+
+static size_t indexPart2(const void* data) {
+    const Index* index = data;
+
+    size_t total_valid = 0;
+    for (size_t i = 0; i < index->n; i++) {
+        total_valid += index->ends[i] - index->starts[i] + 1;
+    }
+    return total_valid;
+}
+
+static void* parseIndex(const char* path) {
+    const Index index = buildIndex(path);
+    if (!index.parse_successful) {
+        return NULL;
+    }
+
+    Index* boxed = aoc_box(&index, sizeof(index));
+    if (!boxed) {
+        perror("Out of memory.");
+        free(index.starts);
+        free(index.ingredients);
+    }
+    return boxed;
+}
+
+static void releaseIndex(void* data) {
+    const Index* index = data;
+    free(index->starts);
+    free(index->ingredients);
+    free(data);
+}
+
+// `size` (partly overlapping) fresh ranges followed by 5 * `size` ingredients, the puzzle's ratio
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    Rng rng = rng_seed(seed);
+    const uint64_t max_id = 560000000000000ull;
+
+    for (size_t i = 0; i < size; i++) {
+        const uint64_t start = rng_range(&rng, 1, max_id);
+        fprintf(out, "%" PRIu64 "-%" PRIu64 "\n", start, start + rng_range(&rng, 0, max_id / 100));
+    }
+    fprintf(out, "\n");
+    for (size_t i = 0; i < 5 * size; i++) {
+        fprintf(out, "%" PRIu64 "\n", rng_range(&rng, 1, max_id));
+    }
+    return !ferror(out);
+}
+
+static const AocVariant VARIANTS[] = {
+    { .name = "index", .part1 = indexPart1, .part2 = indexPart2, .parse = parseIndex, .release = releaseIndex },
+};
+
+const AocDay day05 = {
+    .name = "day05",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+    .variants = VARIANTS,
+    .n_variants = sizeof(VARIANTS) / sizeof(*VARIANTS),
+};
+
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day05, argc, argv);
 }
+#endif
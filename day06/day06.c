@@ -1,14 +1,20 @@
-#include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aoc.h"
+#include "arena.h"
+#include "input.h"
+#include "rng.h"
+
 typedef struct {
     size_t* numbers;
     char* signs;
     const size_t rows;
     const size_t cols;
+    // owns `numbers` and `signs`
+    Arena arena;
     const bool parse_successful;
 } Data1;
 
@@ -16,14 +22,16 @@ typedef struct {
     char** lines;
     const size_t rows;
     char* signs;
+    // owns `lines`, every line and `signs`
+    Arena arena;
     const bool parse_successful;
 } Data2;
 
-bool isDigit(const char c) {
+static bool isDigit(const char c) {
     return '0' <= c && c <= '9';
 }
 
-size_t parseInt(const char* line, const size_t start, const size_t end) {
+static size_t parseInt(const char* line, const size_t start, const size_t end) {
     size_t num = 0;
     for (size_t i = start; i < end; i++) {
         num = num * 10 + (size_t) (line[i] - '0');
@@ -31,7 +39,7 @@ size_t parseInt(const char* line, const size_t start, const size_t end) {
     return num;
 }
 
-size_t nNumbers(const char* line) {
+static size_t nNumbers(const char* line, const size_t len) {
     size_t cols = 0;
 
     size_t i = 0;
@@ -39,7 +47,7 @@ size_t nNumbers(const char* line) {
         i++;
     }
 
-    while (i < strlen(line) && line[i] != '\n') {
+    while (i < len) {
         while (isDigit(line[i])) {
             i++;
         }
@@ -53,12 +61,7 @@ size_t nNumbers(const char* line) {
     return cols;
 }
 
-size_t* parseInts(const char* line, const size_t cols) {
-    size_t* numbers = malloc(sizeof(size_t) * cols);
-    if (!numbers) {
-        return NULL;
-    }
-
+static void parseInts(const char* line, const size_t cols, size_t* numbers) {
     size_t i = 0;
     while (line[i] == ' ') {
         i++;
@@ -74,16 +77,9 @@ size_t* parseInts(const char* line, const size_t cols) {
             i++;
         } while (line[i] == ' ');
     }
-
-    return numbers;
 }
 
-char* parseSigns(const char* line, const size_t cols) {
-    char* signs = malloc(sizeof(char) * cols);
-    if (!signs) {
-        return NULL;
-    }
-
+static void parseSigns(const char* line, const size_t cols, char* signs) {
     size_t i = 0;
     while (line[i] == ' ') {
         i++;
@@ -95,72 +91,65 @@ char* parseSigns(const char* line, const size_t cols) {
             i++;
         } while (line[i] == ' ');
     }
-
-    return signs;
 }
 
-Data1 parseFilePart1(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
-        goto error;
+// all lines of the input with trailing blank lines dropped; rows of numbers followed by the signs
+static bool readLines(Input* input, const char* path, Line** lines, size_t* n_lines) {
+    if (!input_open(input, path)) {
+        return false;
     }
-
-    char* line = NULL;
-    size_t len;
-    if (getline(&line, &len, fp) < 0) {
-    error_1:
-        fclose(fp);
-        goto error;
+    if (!input_lines(input, lines, n_lines)) {
+        input_close(input);
+        return false;
     }
 
-    const size_t cols = nNumbers(line);
-    size_t* numbers = parseInts(line, cols);
-    size_t rows = 1;
-
-    if (!numbers) {
-        perror("Out of memory.");
-    error_2:
-        free(line);
-        goto error_1;
+    while (*n_lines > 0 && !(*lines)[*n_lines - 1].len) {
+        (*n_lines)--;
     }
+    if (*n_lines < 2) {
+        free(*lines);
+        input_close(input);
+        return false;
+    }
+    return true;
+}
 
-    while (getline(&line, &len, fp) > 0 && line[0] != '*' && line[0] != '+') {
-        size_t* nextInts = parseInts(line, cols);
-        if (!nextInts) {
-            perror("Out of memory.");
-        error_3:
-            free(numbers);
-            goto error_2;
-        }
-        size_t* new = realloc(numbers, sizeof(size_t) * (rows + 1) * cols);
-        if (!new) {
-            perror("Out of memory.");
-            free(nextInts);
-            goto error_3;
-        }
-
-        numbers = new;
-        memcpy(numbers + rows*cols, nextInts, sizeof(size_t) * cols);
-        rows++;
-
-        free(nextInts);
+static Data1 parseFilePart1(const char* path) {
+    Input input;
+    Line* lines;
+    size_t n_lines;
+    if (!readLines(&input, path, &lines, &n_lines)) {
+        goto error;
     }
-    fclose(fp);
 
-    char* signs = parseSigns(line, cols);
-    free(line);
-    if (!signs) {
-        free(numbers);
+    // every row has as many numbers as the first, so both arrays fit one exactly sized block
+    const size_t rows = n_lines - 1;
+    const size_t cols = nNumbers(lines[0].str, lines[0].len);
+    Arena arena;
+    arena_init(&arena, sizeof(size_t) * rows * cols + cols);
+    size_t* numbers = ARENA_NEW(&arena, size_t, rows * cols);
+    char* signs = ARENA_NEW(&arena, char, cols);
+    if (!numbers || !signs) {
+        perror("Out of memory.");
+        arena_free(&arena);
+        free(lines);
+        input_close(&input);
         goto error;
     }
 
-    return (Data1) { numbers, signs, rows, cols, true };
+    for (size_t row = 0; row < rows; row++) {
+        parseInts(lines[row].str, cols, numbers + row*cols);
+    }
+    parseSigns(lines[rows].str, cols, signs);
+
+    free(lines);
+    input_close(&input);
+    return (Data1) { numbers, signs, rows, cols, arena, true };
 error:
-    return (Data1) { NULL, NULL, 0, 0, false };
+    return (Data1) { NULL, NULL, 0, 0, { NULL, 0 }, false };
 }
 
-size_t solveColumn1(const Data1* data, const size_t col) {
+static size_t solveColumn1(const Data1* data, const size_t col) {
     const char sign = data->signs[col];
 
     size_t acc = data->numbers[col];
@@ -181,44 +170,21 @@ size_t solveColumn1(const Data1* data, const size_t col) {
     return acc;
 }
 
-size_t part1(const char* path) {
-    const Data1 data = parseFilePart1(path);
-    if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 0;
-    }
-
+static size_t part1(const Data1* data) {
     size_t total = 0;
-    for (size_t i = 0; i < data.cols; i++) {
-        total += solveColumn1(&data, i);
+    for (size_t i = 0; i < data->cols; i++) {
+        total += solveColumn1(data, i);
     }
 
-    free(data.numbers);
-    free(data.signs);
-
     return total;
 }
 
-bool containsSign(const char* line) {
-    for (size_t i = 0; i < strlen(line); i++) {
-        if (line[i] == '+' || line[i] == '*') {
-            return true;
-        }
-    }
-    return false;
+static void freeData1(const Data1* data) {
+    Arena arena = data->arena;
+    arena_free(&arena);
 }
 
-size_t countSigns(const char* line) {
-    size_t n = 0;
-    for (size_t i = 0; i < strlen(line); i++) {
-        if (line[i] == '+' || line[i] == '*') {
-            n++;
-        }
-    }
-    return n;
-}
-
-size_t indexNextSign(const char* line, size_t offset) {
+static size_t indexNextSign(const char* line, size_t offset) {
     for (size_t i = offset + 1; i < strlen(line); i++) {
         if (line[i] == '+' || line[i] == '*') {
             return i;
@@ -228,63 +194,72 @@ size_t indexNextSign(const char* line, size_t offset) {
     return strlen(line);
 }
 
-Data2 parseFilePart2(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+// a NUL-terminated copy of `line` that always ends in '\n', which the column bookkeeping below counts on
+static char* copyLine(Arena* arena, const Line* line, const size_t width) {
+    char* copy = ARENA_NEW(arena, char, width + 2);
+    if (!copy) {
+        return NULL;
+    }
+
+    const size_t len = line->len < width ? line->len : width;
+    memcpy(copy, line->str, len);
+    memset(copy + len, ' ', width - len);
+    copy[width] = '\n';
+    copy[width + 1] = '\0';
+    return copy;
+}
+
+static Data2 parseFilePart2(const char* path) {
+    Input input;
+    Line* in;
+    size_t n_in;
+    if (!readLines(&input, path, &in, &n_in)) {
         goto error;
     }
 
-    char** lines = NULL;
-    char* line = NULL;
-    size_t n_lines = 0, chars_per_line = 0, len;
-    while (getline(&line, &len, fp) > 0) {
-        if (containsSign(line)) {
-            for (size_t curr_sign = 0, next_sign = indexNextSign(line, curr_sign); curr_sign < chars_per_line; curr_sign = next_sign, next_sign = indexNextSign(line, curr_sign)) {
-                for (size_t i = curr_sign; i <= next_sign - 2; i++) {
-                    for (size_t row = 0; row < n_lines; row++) {
-                        if (!isDigit(lines[row][i])) {
-                            lines[row][i] = '0';
-                        }
-                    }
-                }
-            }
-        } else {
-            if (!chars_per_line) {
-                // lines are equal size anyways
-                chars_per_line = strlen(line);
-            }
+    // lines are equal size anyways
+    const size_t n_lines = n_in - 1;
+    const size_t width = in[0].len;
+    const size_t chars_per_line = width + 1;
+
+    // the row pointers and every padded row (and the sign row) in one block
+    Arena arena;
+    arena_init(&arena, sizeof(char*) * n_lines + (width + 2) * n_in + alignof(char*));
+
+    char** lines = ARENA_NEW(&arena, char*, n_lines);
+    char* line = lines ? copyLine(&arena, &in[n_lines], width) : NULL;
+    for (size_t row = 0; line && row < n_lines; row++) {
+        lines[row] = copyLine(&arena, &in[row], width);
+        if (!lines[row]) {
+            line = NULL;
+        }
+    }
+    if (!line) {
+        perror("Out of memory.");
+        arena_free(&arena);
+        free(in);
+        input_close(&input);
+        goto error;
+    }
+    free(in);
+    input_close(&input);
 
-            char** new = realloc(lines, sizeof(char*) * (n_lines + 1));
-            if (!new) {
-                perror("Out of memory.");
-            error_1:
-                for (size_t i = 0; i < n_lines; i++) {
-                    free(lines[i]);
+    for (size_t curr_sign = 0, next_sign = indexNextSign(line, curr_sign); curr_sign < chars_per_line; curr_sign = next_sign, next_sign = indexNextSign(line, curr_sign)) {
+        for (size_t i = curr_sign; i <= next_sign - 2; i++) {
+            for (size_t row = 0; row < n_lines; row++) {
+                if (!isDigit(lines[row][i])) {
+                    lines[row][i] = '0';
                 }
-                free(lines);
-                free(line);
-                goto error;
-            }
-            lines = new;
-
-            char* curr_line = malloc(sizeof(char) * (chars_per_line + 1));
-            if (!curr_line) {
-                perror("Out of memory.");
-                goto error_1;
             }
-            lines[n_lines++] = curr_line;
-            memcpy(curr_line, line, chars_per_line + 1);
         }
     }
-    fclose(fp);
 
-    return (Data2) { lines, n_lines, line, true };
+    return (Data2) { lines, n_lines, line, arena, true };
 error:
-    return (Data2) { NULL, 0, NULL, false };
+    return (Data2) { NULL, 0, NULL, { NULL, 0 }, false };
 }
 
-size_t arithmeticallyNeutral(const char sign) {
+static size_t arithmeticallyNeutral(const char sign) {
     switch (sign) {
         case '+':
             return 0;
@@ -295,22 +270,16 @@ size_t arithmeticallyNeutral(const char sign) {
     }
 }
 
-size_t part2(const char* path) {
-    const Data2 data = parseFilePart2(path);
-    if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 0;
-    }
-
+static size_t part2(const Data2* data) {
     size_t total = 0;
-    for (size_t curr_sign = 0, next_sign = indexNextSign(data.signs, curr_sign); curr_sign < strlen(data.signs); curr_sign = next_sign, next_sign = indexNextSign(data.signs, curr_sign)) {
-        const char sign = data.signs[curr_sign];
+    for (size_t curr_sign = 0, next_sign = indexNextSign(data->signs, curr_sign); curr_sign < strlen(data->signs); curr_sign = next_sign, next_sign = indexNextSign(data->signs, curr_sign)) {
+        const char sign = data->signs[curr_sign];
         size_t subtotal = arithmeticallyNeutral(sign);
 
         for (size_t i = curr_sign; i <= next_sign - 2; i++) {
             size_t number = 0;
-            for (size_t row = 0; row < data.rows; row++) {
-                const char digit = data.lines[row][i];
+            for (size_t row = 0; row < data->rows; row++) {
+                const char digit = data->lines[row][i];
                 if (digit != '0') {
                     number = number * 10 + (size_t) (digit - '0');
                 }
@@ -325,29 +294,125 @@ size_t part2(const char* path) {
                     break;
                 default:
                     fprintf(stderr, "Invalid sign encountered: %c\n", sign);
-                    total = 0;
-                    goto end;
+                    return 0;
             }
         }
         total += subtotal;
     }
 
-end:
-    for (size_t i = 0; i < data.rows; i++) {
-        free(data.lines[i]);
+    return total;
+}
+
+static void freeData2(const Data2* data) {
+    Arena arena = data->arena;
+    arena_free(&arena);
+}
+
+static void* parse1(const char* path) {
+    const Data1 data = parseFilePart1(path);
+    if (!data.parse_successful) {
+        return NULL;
     }
-    free(data.lines);
-    free(data.signs);
 
-    return total;
+    Data1* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData1(&data);
+    }
+    return boxed;
 }
 
-int main(void) {
-    const char* path = "inputs/day06.txt";
+static void* parse2(const char* path) {
+    const Data2 data = parseFilePart2(path);
+    if (!data.parse_successful) {
+        return NULL;
+    }
+
+    Data2* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData2(&data);
+    }
+    return boxed;
+}
+
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
 
-    const size_t p1 = part1(path);
-    printf("Part 1: %zu\n", p1);
+static void release1(void* data) {
+    freeData1(data);
+    free(data);
+}
+
+static void release2(void* data) {
+    freeData2(data);
+    free(data);
+}
+
+// `size` problems (at least one) of four numbers each, laid out in aligned columns like the puzzle's;
+// digits are 1-9 only since part 2 treats '0' as padding
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    enum { ROWS = 4, MAX_DIGITS = 4 };
+
+    // each problem is at most MAX_DIGITS wide plus a separating column
+    const size_t n_problems = size ? size : 1;
+    const size_t width = n_problems * (MAX_DIGITS + 1);
+    char* lines = malloc((ROWS + 1) * (width + 1));
+    if (!lines) {
+        perror("Out of memory.");
+        return false;
+    }
+    memset(lines, ' ', (ROWS + 1) * (width + 1));
+
+    Rng rng = rng_seed(seed);
+    size_t col = 0;
+    for (size_t p = 0; p < n_problems; p++) {
+        const size_t problem_width = rng_range(&rng, 1, MAX_DIGITS);
+        const bool align_right = rng_chance(&rng, 50);
+
+        // the widest number decides the width of the problem
+        const size_t widest = rng_range(&rng, 0, ROWS - 1);
+        for (size_t row = 0; row < ROWS; row++) {
+            const size_t digits = row == widest ? problem_width : rng_range(&rng, 1, problem_width);
+            const size_t offset = align_right ? problem_width - digits : 0;
+            for (size_t d = 0; d < digits; d++) {
+                lines[row * (width + 1) + col + offset + d] = (char) ('0' + rng_range(&rng, 1, 9));
+            }
+        }
+        lines[ROWS * (width + 1) + col] = rng_chance(&rng, 50) ? '+' : '*';
+        col += problem_width + 1;
+    }
+
+    // every line is padded to the same length, up to the end of the last problem
+    const size_t line_len = col - 1;
+    for (size_t row = 0; row <= ROWS; row++) {
+        char* line = &lines[row * (width + 1)];
+        line[line_len] = '\n';
+        fwrite(line, 1, line_len + 1, out);
+    }
+
+    free(lines);
+    return !ferror(out);
+}
 
-    const size_t p2 = part2(path);
-    printf("Part 2: %zu\n", p2);
+const AocDay day06 = {
+    .name = "day06",
+    .parse = parse1,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release1,
+    .parse_part2 = parse2,
+    .release_part2 = release2,
+    .generate = generate,
+};
+
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day06, argc, argv);
 }
+#endif
@@ -1,75 +1,77 @@
-#include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aoc.h"
+#include "arena.h"
+#include "input.h"
+#include "rng.h"
+
 typedef struct {
     char** lines;
     const size_t start_x;
     const size_t width, depth;
+    // owns `lines` and every line
+    Arena arena;
     const bool parse_successful;
 } Data;
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
         goto error;
     }
 
-    char** lines = NULL;
-    char* line = NULL;
-    size_t n = 0, start_x = 0, len;
-    while (getline(&line, &len, fp) > 0) {
-        len = strlen(line);
-        if (line[len - 1] == '\n') {
-            line[--len] = '\0';
-        }
-        if (!len) {
-            break;
-        }
+    // the manifold ends at the first blank line, which also bounds the line array exactly
+    size_t n_lines = 0, pos = 0;
+    Line line;
+    while (input_next_line(&input, &pos, &line) && line.len) {
+        n_lines++;
+    }
+    if (!n_lines) {
+        input_close(&input);
+        goto error;
+    }
+
+    // the line array and all lines back to back; the manifold is at most the bytes before the blank line
+    Arena arena;
+    arena_init(&arena, n_lines * sizeof(char*) + pos + n_lines);
+
+    char** lines = ARENA_NEW(&arena, char*, n_lines);
+    if (!lines) {
+        perror("Out of memory.");
+        input_close(&input);
+        goto error;
+    }
 
+    size_t n = 0, start_x = 0;
+    pos = 0;
+    while (n < n_lines && input_next_line(&input, &pos, &line)) {
         if (!start_x) {
-            for (size_t x = 0; x < len; x++) {
-                if (line[x] == 'S') {
-                    start_x = x;
-                    break;
-                }
+            const char* s = memchr(line.str, 'S', line.len);
+            if (s) {
+                start_x = (size_t) (s - line.str);
             }
         }
 
-        char** new = realloc(lines, (n + 1) * sizeof(char*));
-        if (!new) {
-            perror("Out of memory.");
-            goto error_1;
-        }
-        lines = new;
-
-        char* memline = malloc(len + 1);
+        char* memline = arena_strndup(&arena, line.str, line.len);
         if (!memline) {
             perror("Out of memory.");
-        error_1:
-            for (size_t i = 0; i < n; i++) {
-                free(lines[i]);
-            }
-            free(lines);
-            free(line);
-            fclose(fp);
+            arena_free(&arena);
+            input_close(&input);
             goto error;
         }
-        strcpy(memline, line);
         lines[n++] = memline;
     }
-    free(line);
-    fclose(fp);
+    input_close(&input);
 
-    return (Data) { .lines = lines, .start_x = start_x, .width = strlen(lines[0]), .depth = n, .parse_successful = true };
+    return (Data) { .lines = lines, .start_x = start_x, .width = strlen(lines[0]), .depth = n, .arena = arena, .parse_successful = true };
 error:
-    return (Data) { .lines = NULL, .start_x = 0, .width = 0, .depth = 0, .parse_successful = false };
+    return (Data) { .lines = NULL, .start_x = 0, .width = 0, .depth = 0, .arena = { NULL, 0 }, .parse_successful = false };
 }
 
-size_t countSplits(char** grid, const size_t depth) {
+static size_t countSplits(char** grid, const size_t depth) {
     size_t splits = 0;
     for (size_t curr = 1, prev = 0; curr < depth; curr++, prev++) {
         for (size_t col = 0; col < strlen(grid[curr]); col++) {
@@ -86,7 +88,12 @@ size_t countSplits(char** grid, const size_t depth) {
     return splits;
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
+    // the beam starts on the row below S, so a manifold without one has nothing to split
+    if (data->depth < 2) {
+        return 0;
+    }
+
     char** grid = malloc(data->depth * sizeof(char*));
     if (!grid) {
         perror("Out of memory.");
@@ -116,7 +123,7 @@ size_t part1(const Data* data) {
     return splits;
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     size_t* curr = calloc(data->width, sizeof(size_t));
     if (!curr) {
         perror("Out of memory.");
@@ -161,23 +168,81 @@ size_t part2(const Data* data) {
     return total_beams;
 }
 
-int main(void) {
-    const char* path = "inputs/day07.txt";
+static void freeData(const Data* data) {
+    Arena arena = data->arena;
+    arena_free(&arena);
+}
 
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
     }
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
+    }
+    return boxed;
+}
+
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
 
-    for (size_t i = 0; i < data.depth; i++) {
-        free(data.lines[i]);
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// a manifold `size` columns wide and `size` + 1 rows deep with splitters in the puzzle's
+// triangle layout below S, every other row and every other column, some left out
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    const size_t width = size < 3 ? 3 : size;
+    char* line = malloc(width + 1);
+    if (!line) {
+        perror("Out of memory.");
+        return false;
     }
-    free(data.lines);
+
+    Rng rng = rng_seed(seed);
+    const size_t center = width / 2;
+    line[width] = '\n';
+    for (size_t y = 0; y <= width; y++) {
+        memset(line, '.', width);
+        if (y == 0) {
+            line[center] = 'S';
+        } else if (y % 2 == 0) {
+            const size_t reach = y / 2 - 1;
+            for (size_t x = center >= reach ? center - reach : (reach - center) % 2; x <= center + reach && x < width - 1; x += 2) {
+                if (x > 0 && rng_chance(&rng, 85)) {
+                    line[x] = '^';
+                }
+            }
+        }
+        fwrite(line, 1, width + 1, out);
+    }
+
+    free(line);
+    return !ferror(out);
+}
+
+const AocDay day07 = {
+    .name = "day07",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+};
+
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day07, argc, argv);
 }
+#endif
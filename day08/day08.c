@@ -1,10 +1,15 @@
-#include <errno.h>
+#include <inttypes.h>
 #include <math.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aoc.h"
+#include "input.h"
+#include "rng.h"
+#include "scan.h"
+
 typedef struct {
     long x;
     long y;
@@ -17,61 +22,38 @@ typedef struct {
     const bool parse_successful;
 } Data;
 
-bool isDigit(const char c) {
-    return '0' <= c && c <= '9';
-}
-
-size_t parseInt(const char* line, const size_t start, const size_t end) {
-    size_t num = 0;
-    for (size_t i = start; i < end; i++) {
-        num = num * 10 + (size_t) (line[i] - '0');
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
     }
-    return num;
-}
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+    // one junction box per line, so the array is allocated exactly once
+    const size_t n_lines = input_count_lines(&input);
+    Vec3* boxes = malloc(sizeof(Vec3) * (n_lines ? n_lines : 1));
+    if (!boxes) {
+        perror("Out of memory.");
+        input_close(&input);
         goto error;
     }
 
-    Vec3* boxes = NULL;
-    char* line = NULL;
-    size_t n = 0, len;
-    while (getline(&line, &len, fp) > 0) {
-        size_t start = 0, end = 1;
-        while (isDigit(line[end])) {
-            end++;
+    // numbers may be read past the end of their line, the digit run stops at the '\n' anyway
+    const char* end = input.data + input.size;
+    size_t n = 0, pos = 0;
+    Line line;
+    while (input_next_line(&input, &pos, &line)) {
+        if (!line.len) {
+            continue;
         }
-        const long x = (long) parseInt(line, start, end);
 
-        start = ++end;
-        while (isDigit(line[end])) {
-            end++;
-        }
-        const long y = (long) parseInt(line, start, end);
+        size_t x, y, z;
+        const char* p = scan_uint(line.str, end, &x);
+        p = scan_uint(p + 1, end, &y);
+        scan_uint(p + 1, end, &z);
 
-        start = ++end;
-        while (isDigit(line[end])) {
-            end++;
-        }
-        const long z = (long) parseInt(line, start, end);
-
-        Vec3* new = realloc(boxes, sizeof(Vec3) * (n + 1));
-        if (!new) {
-            perror("Out of memory.");
-            free(boxes);
-            free(line);
-            fclose(fp);
-            goto error;
-        }
-
-        boxes = new;
-        boxes[n++] = (Vec3) { x, y, z };
+        boxes[n++] = (Vec3) { (long) x, (long) y, (long) z };
     }
-    free(line);
-    fclose(fp);
+    input_close(&input);
 
     return (Data) { boxes, n, true };
 error:
@@ -104,7 +86,7 @@ typedef struct {
     size_t n;
 } Vec3Array;
 
-double straight_line_distance(const Vec3* a, const Vec3* b) {
+static double straight_line_distance(const Vec3* a, const Vec3* b) {
     const double x_a = (double) a->x, x_b = (double) b->x;
     const double y_a = (double) a->y, y_b = (double) b->y;
     const double z_a = (double) a->z, z_b = (double) b->z;
@@ -116,7 +98,7 @@ double straight_line_distance(const Vec3* a, const Vec3* b) {
     return sqrt(d_x * d_x + d_y * d_y + d_z * d_z);
 }
 
-int compare(const void* a, const void* b) {
+static int compare(const void* a, const void* b) {
     const double a_distance = ((const Distance*) a)->distance;
     const double b_distance = ((const Distance*) b)->distance;
 
@@ -125,8 +107,12 @@ int compare(const void* a, const void* b) {
     return 0;
 }
 
-Distances distances(const Vec3* boxes, const size_t n) {
+static Distances distances(const Vec3* boxes, const size_t n) {
+    // fewer than two boxes have no pairs, and callers take an empty result as nothing to connect
     const size_t n_pairwise = n * (n - 1) / 2;
+    if (!n_pairwise) {
+        return (Distances) { NULL, 0 };
+    }
     Distance* dists = malloc(sizeof(Distance) * n_pairwise);
     if (!dists) {
         perror("Out of memory.");
@@ -146,7 +132,7 @@ Distances distances(const Vec3* boxes, const size_t n) {
     return (Distances) { dists, n_pairwise };
 }
 
-Vec3Array neighbors(const Connection* edges, const size_t n_edges, const Vec3* source) {
+static Vec3Array neighbors(const Connection* edges, const size_t n_edges, const Vec3* source) {
     size_t n_neighbors = 0;
     for (size_t i = 0; i < n_edges; i++) {
         const Vec3* a = edges[i].a;
@@ -180,7 +166,7 @@ error:
     return (Vec3Array) { NULL, 0 };
 }
 
-void add_to_component(Vec3Array* component, const Vec3* node) {
+static void add_to_component(Vec3Array* component, const Vec3* node) {
     const Vec3** new = realloc(component->nodes, sizeof(const Vec3*) * (component->n + 1));
     if (!new) {
         exit(1);
@@ -190,7 +176,7 @@ void add_to_component(Vec3Array* component, const Vec3* node) {
     component->nodes[component->n++] = node;
 }
 
-bool contains(const Vec3Array* array, const Vec3* node) {
+static bool contains(const Vec3Array* array, const Vec3* node) {
     for (size_t i = 0; i < array->n; i++) {
         if (array->nodes[i] == node) {
             return true;
@@ -199,7 +185,7 @@ bool contains(const Vec3Array* array, const Vec3* node) {
     return false;
 }
 
-void findComponent(const Connection* edges, const size_t n_edges, const Vec3* source, Vec3Array* component) {
+static void findComponent(const Connection* edges, const size_t n_edges, const Vec3* source, Vec3Array* component) {
     add_to_component(component, source);
 
     const Vec3Array nghbrs = neighbors(edges, n_edges, source);
@@ -216,7 +202,7 @@ void findComponent(const Connection* edges, const size_t n_edges, const Vec3* so
     free(nghbrs.nodes);
 }
 
-bool isEqual(const Vec3Array* a, const Vec3Array* b) {
+static bool isEqual(const Vec3Array* a, const Vec3Array* b) {
     if (a->n != b->n) {
         return false;
     }
@@ -229,7 +215,7 @@ bool isEqual(const Vec3Array* a, const Vec3Array* b) {
     return true;
 }
 
-int compareVec3ArraysAsc(const void* a, const void* b) {
+static int compareVec3ArraysAsc(const void* a, const void* b) {
     const size_t a_n = ((const Vec3Array*) a)->n;
     const size_t b_n = ((const Vec3Array*) b)->n;
 
@@ -238,13 +224,13 @@ int compareVec3ArraysAsc(const void* a, const void* b) {
     return 0;
 }
 
-void freeVec3Arrays(Vec3Array* arrays, const size_t n) {
+static void freeVec3Arrays(Vec3Array* arrays, const size_t n) {
     for (size_t i = 0; i < n; i++) {
         free(arrays[i].nodes);
     }
 }
 
-size_t part1(const Data* data, const size_t n_junctions, const size_t top_k) {
+static size_t part1(const Data* data, const size_t n_junctions, const size_t top_k) {
     const Distances dists = distances(data->boxes, data->n);
     if (!dists.n) {
         goto error;
@@ -275,16 +261,21 @@ size_t part1(const Data* data, const size_t n_junctions, const size_t top_k) {
         components[i] = (Vec3Array) { NULL, 0 };
     }
 
-    outer: for (size_t i = 0; i < n_junctions; i++) {
+    for (size_t i = 0; i < n_junctions; i++) {
         free(components[top_k].nodes);
         components[top_k] = (Vec3Array) { NULL, 0 };
         findComponent(connections, n_junctions, connections[i].a, &components[top_k]);
 
+        bool known = false;
         for (size_t j = 0; j < top_k; j++) {
             if (isEqual(&components[top_k], &components[j])) {
-                continue outer;
+                known = true;
+                break;
             }
         }
+        if (known) {
+            continue;
+        }
         qsort(components, top_k+1, sizeof(Vec3Array), compareVec3ArraysAsc);
     }
 
@@ -307,7 +298,7 @@ typedef struct {
     size_t count;
 } Components;
 
-Components initComponents(const Data* data) {
+static Components initComponents(const Data* data) {
     Components c = (Components) { NULL, data->n, data->n };
     c.id = malloc(sizeof(size_t) * c.n);
     if (!c.id) {
@@ -321,7 +312,7 @@ Components initComponents(const Data* data) {
     return c;
 }
 
-bool addConnectionStep(Components* comps, const Vec3* a, const Vec3* b, const Vec3* boxes) {
+static bool addConnectionStep(Components* comps, const Vec3* a, const Vec3* b, const Vec3* boxes) {
     size_t ca = comps->id[(size_t) (a - boxes)];
     size_t cb = comps->id[(size_t) (b - boxes)];
 
@@ -339,7 +330,7 @@ bool addConnectionStep(Components* comps, const Vec3* a, const Vec3* b, const Ve
     return true;
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     const Distances dists = distances(data->boxes, data->n);
     if (!dists.n) {
         return 0;
@@ -368,22 +359,78 @@ size_t part2(const Data* data) {
     return 0;
 }
 
-int main(void) {
-    const char* path = "inputs/day08.txt";
-    const size_t n_junctions = 1000;
-    const size_t top_k = 3;
+static void freeData(const Data* data) {
+    free(data->boxes);
+}
 
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
     }
 
-    const size_t p1 = part1(&data, n_junctions, top_k);
-    printf("Part 1: %zu\n", p1);
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
+    }
+    return boxed;
+}
+
+// how many of the closest pairs part 1 connects: 1000 in the puzzle, `-o junctions=10` for its
+// 20 box example
+#define JUNCTIONS 1000
+static size_t puzzle_junctions = JUNCTIONS;
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+static bool configure(const char* option) {
+    if (!option) {
+        puzzle_junctions = JUNCTIONS;
+        return true;
+    }
+    return aoc_option_size(option, "junctions", &puzzle_junctions);
+}
+
+static size_t solvePart1(const void* data) {
+    // an input with fewer pairs than that has all of them connected
+    const Data* d = data;
+    const size_t n_pairwise = d->n * (d->n - 1) / 2;
+    return part1(d, puzzle_junctions < n_pairwise ? puzzle_junctions : n_pairwise, 3);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
+
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// `size` junction boxes with coordinates in the puzzle's range
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    Rng rng = rng_seed(seed);
+    for (size_t i = 0; i < size; i++) {
+        const uint64_t x = rng_range(&rng, 0, 99999);
+        const uint64_t y = rng_range(&rng, 0, 99999);
+        const uint64_t z = rng_range(&rng, 0, 99999);
+        fprintf(out, "%" PRIu64 ",%" PRIu64 ",%" PRIu64 "\n", x, y, z);
+    }
+    return !ferror(out);
+}
 
-    free(data.boxes);
+const AocDay day08 = {
+    .name = "day08",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+    .configure = configure,
+    .options = "junctions=N: part 1 connects the N closest pairs (default 1000, the puzzle's example uses 10)",
+};
+
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day08, argc, argv);
 }
+#endif
@@ -1,9 +1,14 @@
-#include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aoc.h"
+#include "input.h"
+#include "rng.h"
+#include "scan.h"
+
 typedef struct {
     long x;
     long y;
@@ -15,62 +20,44 @@ typedef struct {
     const bool parse_successful;
 } Data;
 
-bool isDigit(const char c) {
-    return '0' <= c && c <= '9';
-}
-
-size_t parseInt(const char* line, const size_t start, const size_t end) {
-    size_t num = 0;
-    for (size_t i = start; i < end; i++) {
-        num = num * 10 + (size_t) (line[i] - '0');
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        goto error;
     }
-    return num;
-}
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+    // one red tile per line, so the array is allocated exactly once
+    const size_t n_lines = input_count_lines(&input);
+    Vec2* tiles = malloc(sizeof(Vec2) * (n_lines ? n_lines : 1));
+    if (!tiles) {
+        perror("Out of memory.");
+        input_close(&input);
         goto error;
     }
 
-    Vec2* tiles = NULL;
-    char* line = NULL;
-    size_t n = 0, len;
-    while (getline(&line, &len, fp) > 0) {
-        size_t start = 0, end = 1;
-        while (isDigit(line[end])) {
-            end++;
+    // numbers may be read past the end of their line, the digit run stops at the '\n' anyway
+    const char* end = input.data + input.size;
+    size_t n = 0, pos = 0;
+    Line line;
+    while (input_next_line(&input, &pos, &line)) {
+        if (!line.len) {
+            continue;
         }
-        const long x = (long) parseInt(line, start, end);
 
-        start = ++end;
-        while (isDigit(line[end])) {
-            end++;
-        }
-        const long y = (long) parseInt(line, start, end);
-
-        Vec2* new = realloc(tiles, sizeof(Vec2) * (n + 1));
-        if (!new) {
-            perror("Out of memory.");
-            free(tiles);
-            free(line);
-            fclose(fp);
-            goto error;
-        }
+        size_t x, y;
+        const char* p = scan_uint(line.str, end, &x);
+        scan_uint(p + 1, end, &y);
 
-        tiles = new;
-        tiles[n++] = (Vec2) { x, y };
+        tiles[n++] = (Vec2) { (long) x, (long) y };
     }
-    free(line);
-    fclose(fp);
+    input_close(&input);
 
     return (Data) { tiles, n, true };
 error:
     return (Data) { NULL, 0, false };
 }
 
-size_t tile_area(const Vec2* a, const Vec2* b) {
+static size_t tile_area(const Vec2* a, const Vec2* b) {
     const long x_a = a->x, y_a = a->y;
     const long x_b = b->x, y_b = b->y;
 
@@ -80,7 +67,7 @@ size_t tile_area(const Vec2* a, const Vec2* b) {
     return (x_distance + 1) * (y_distance + 1);
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
     size_t max_area = 0;
 
     for (size_t i = 0; i < data->n; i++) {
@@ -104,7 +91,7 @@ typedef struct {
     long y2;
 } Edge;
 
-Edge* build_edges(const Data* data) {
+static Edge* build_edges(const Data* data) {
     Edge* edges = malloc(sizeof(Edge) * data->n);
     if (!edges) {
         return NULL;
@@ -119,7 +106,7 @@ Edge* build_edges(const Data* data) {
     return edges;
 }
 
-bool point_inside(const Edge* edges, const size_t n, const long x, const long y) {
+static bool point_inside(const Edge* edges, const size_t n, const long x, const long y) {
     int crossings = 0;
 
     for (size_t i = 0; i < n; i++) {
@@ -151,7 +138,7 @@ bool point_inside(const Edge* edges, const size_t n, const long x, const long y)
     return crossings % 2 == 1;
 }
 
-bool edge_intersects_rect(const Edge* e, const long minx, const long maxx, const long miny, const long maxy) {
+static bool edge_intersects_rect(const Edge* e, const long minx, const long maxx, const long miny, const long maxy) {
     if (e->x1 == e->x2) {
         const long x = e->x1;
         if (x <= minx || x >= maxx) {
@@ -175,7 +162,7 @@ bool edge_intersects_rect(const Edge* e, const long minx, const long maxx, const
     }
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     Edge* edges = build_edges(data);
     if (!edges) {
         return 0;
@@ -185,7 +172,7 @@ size_t part2(const Data* data) {
     for (size_t i = 0; i < data->n; i++) {
         const Vec2 a = data->tiles[i];
 
-        inner: for (size_t j = i + 1; j < data->n; j++) {
+        for (size_t j = i + 1; j < data->n; j++) {
             const Vec2 b = data->tiles[j];
 
             const long minx = a.x < b.x ? a.x : b.x;
@@ -206,11 +193,16 @@ size_t part2(const Data* data) {
                 continue;
             }
 
+            bool intersects = false;
             for (size_t k = 0; k < data->n; k++) {
                 if (edge_intersects_rect(&edges[k], minx, maxx, miny, maxy)) {
-                    continue inner;
+                    intersects = true;
+                    break;
                 }
             }
+            if (intersects) {
+                continue;
+            }
 
             const size_t area = (size_t) (maxx - minx + 1) * (size_t) (maxy - miny + 1);
             if (area > best) {
@@ -223,20 +215,96 @@ size_t part2(const Data* data) {
     return best;
 }
 
-int main(void) {
-    const char* path = "inputs/day09.txt";
+static void freeData(const Data* data) {
+    free(data->tiles);
+}
 
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
     }
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
+    }
+    return boxed;
+}
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
+
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// a simple rectilinear polygon with (about) `size` red tiles as vertices: a staircase above and
+// one below a horizontal center line, both over the same strictly increasing x coordinates
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    const size_t steps = size < 4 ? 1 : size / 4;
+    const uint64_t span = steps * 4 < 100000 ? 100000 : steps * 4;
+    const uint64_t center = span / 2;
+
+    uint64_t* xs = malloc(sizeof(uint64_t) * (steps + 1));
+    uint64_t* above = malloc(sizeof(uint64_t) * steps);
+    uint64_t* below = malloc(sizeof(uint64_t) * steps);
+    if (!xs || !above || !below) {
+        perror("Out of memory.");
+        free(xs);
+        free(above);
+        free(below);
+        return false;
+    }
+
+    Rng rng = rng_seed(seed);
+    xs[0] = rng_range(&rng, 0, span / (steps + 1));
+    for (size_t i = 1; i <= steps; i++) {
+        xs[i] = xs[i - 1] + rng_range(&rng, 1, span / (steps + 1));
+    }
+    // neighbouring steps must differ in height, otherwise two edges would be collinear
+    for (size_t i = 0; i < steps; i++) {
+        do {
+            above[i] = center + rng_range(&rng, 1, center - 1);
+        } while (i > 0 && above[i] == above[i - 1]);
+        do {
+            below[i] = center - rng_range(&rng, 1, center - 1);
+        } while (i > 0 && below[i] == below[i - 1]);
+    }
+
+    for (size_t i = 0; i < steps; i++) {
+        fprintf(out, "%" PRIu64 ",%" PRIu64 "\n", xs[i], above[i]);
+        fprintf(out, "%" PRIu64 ",%" PRIu64 "\n", xs[i + 1], above[i]);
+    }
+    for (size_t i = steps; i > 0; i--) {
+        fprintf(out, "%" PRIu64 ",%" PRIu64 "\n", xs[i], below[i - 1]);
+        fprintf(out, "%" PRIu64 ",%" PRIu64 "\n", xs[i - 1], below[i - 1]);
+    }
+
+    free(xs);
+    free(above);
+    free(below);
+    return !ferror(out);
+}
 
-    free(data.tiles);
+const AocDay day09 = {
+    .name = "day09",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+};
+
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day09, argc, argv);
 }
+#endif
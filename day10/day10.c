@@ -1,10 +1,16 @@
-#include <errno.h>
+#include <inttypes.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aoc.h"
+#include "arena.h"
+#include "input.h"
+#include "rng.h"
+#include "scan.h"
+
 typedef uint32_t bitmask_t;
 
 typedef struct {
@@ -18,39 +24,41 @@ typedef struct {
 typedef struct {
     Machine* machines;
     const size_t n;
+    // owns `machines` and every machine's masks and joltages
+    Arena arena;
     const bool parse_successful;
 } Data;
 
-void free_machine(Machine* m) {
-    free(m->masks);
-    free(m->joltages);
-}
-
-size_t count_char(const char *s, const char c) {
-    size_t count = 0;
-    for (size_t i = 0; s[i]; i++) {
-        if (s[i] == c) {
-            count++;
-        }
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        return (Data) {
+            .machines = NULL,
+            .n = 0,
+            .arena = { NULL, 0 },
+            .parse_successful = false,
+        };
     }
-    return count;
-}
-
-bool is_digit(const char c) {
-    return '0' <= c && c <= '9';
-}
 
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+    // one machine per line, so the array is allocated exactly once; the masks and joltages
+    // that follow take roughly twice the bytes of the text they are parsed from
+    const size_t n_lines = input_count_lines(&input);
+    Arena arena;
+    arena_init(&arena, n_lines * sizeof(Machine) + 2 * input.size);
+    Machine* machines = ARENA_NEW(&arena, Machine, n_lines ? n_lines : 1);
+    size_t n_machines = 0, pos = 0;
+    if (!machines) {
+        perror("Out of memory.");
         goto error;
     }
 
-    Machine* machines = NULL;
-    char* line = NULL;
-    size_t n_machines = 0, len;
-    while (getline(&line, &len, fp) > 0) {
+    Line l;
+    while (input_next_line(&input, &pos, &l)) {
+        if (!l.len) {
+            continue;
+        }
+        const char* line = l.str;
+
         const size_t start = 1;
         size_t i = start;
         bitmask_t target = 0;
@@ -66,8 +74,8 @@ Data parseFile(const char* path) {
         // skip ']' and ' ' and '('
         i += 3;
 
-        const size_t n_masks = count_char(line, '(');
-        bitmask_t* masks = malloc(n_masks * sizeof(bitmask_t));
+        const size_t n_masks = input_count_char(line, l.len, '(');
+        bitmask_t* masks = ARENA_NEW(&arena, bitmask_t, n_masks);
         if (!masks) {
             perror("Out of memory.");
             goto error;
@@ -91,32 +99,18 @@ Data parseFile(const char* path) {
         // skip '{'
         i++;
 
-        size_t* joltages = malloc(n_buttons * sizeof(size_t));
+        size_t* joltages = ARENA_NEW(&arena, size_t, n_buttons);
         if (!joltages) {
             perror("Out of memory.");
-        error_1:
-            free(masks);
             goto error;
         }
+        const char* p = line + i;
         for (size_t j = 0; j < n_buttons; j++) {
-            joltages[j] = 0;
-            while (is_digit(line[i])) {
-                joltages[j] *= 10;
-                joltages[j] += (size_t) (line[i] - '0');
-                i++;
-            }
+            p = scan_uint(p, input.data + input.size, &joltages[j]);
             // skip ','
-            i++;
+            p++;
         }
 
-        Machine* new = realloc(machines, (n_machines + 1) * sizeof(Machine));
-        if (!new) {
-            perror("Out of memory.");
-            free(joltages);
-            goto error_1;
-        }
-        machines = new;
-
         machines[n_machines++] = (Machine) {
             .target = target,
             .n_buttons = n_buttons,
@@ -125,32 +119,28 @@ Data parseFile(const char* path) {
             .joltages = joltages,
         };
     }
-    free(line);
-    fclose(fp);
+    input_close(&input);
 
     return (Data) {
         .machines = machines,
         .n = n_machines,
+        .arena = arena,
         .parse_successful = true,
     };
 
 error:
-    free(line);
-    fclose(fp);
-
-    for (size_t i = 0; i < n_machines; i++) {
-        free_machine(&machines[i]);
-    }
-    free(machines);
+    input_close(&input);
+    arena_free(&arena);
 
     return (Data) {
         .machines = NULL,
         .n = 0,
+        .arena = { NULL, 0 },
         .parse_successful = false,
     };
 }
 
-size_t popcount(const size_t state, const size_t n_buttons) {
+static size_t popcount(const size_t state, const size_t n_buttons) {
     size_t count = 0;
     for (size_t i = 0; i < n_buttons; i++) {
         if ((state >> i) & 1) {
@@ -160,7 +150,7 @@ size_t popcount(const size_t state, const size_t n_buttons) {
     return count;
 }
 
-size_t solve_machine_bruteforce(const Machine *m) {
+static size_t solve_machine_bruteforce(const Machine *m) {
     const size_t M = m->n_masks;
     const bitmask_t target = m->target;
 
@@ -185,7 +175,7 @@ size_t solve_machine_bruteforce(const Machine *m) {
     return best;
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
     size_t total = 0;
     for (size_t i = 0; i < data->n; i++) {
         total += solve_machine_bruteforce(&data->machines[i]);
@@ -194,27 +184,95 @@ size_t part1(const Data* data) {
     return total;
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     return data->n ^ data->n;
 }
 
-int main(void) {
-    const char* path = "inputs/day10.txt";
+static void freeData(const Data* data) {
+    Arena arena = data->arena;
+    arena_free(&arena);
+}
 
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
+    }
+
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
     }
+    return boxed;
+}
+
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
+
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+// `size` machines of up to 10 lights and 13 buttons like the puzzle's; the target is always
+// the XOR of some buttons so that every machine is solvable
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    Rng rng = rng_seed(seed);
+    for (size_t m = 0; m < size; m++) {
+        const size_t n_lights = rng_range(&rng, 4, 10);
+        const size_t n_buttons = rng_range(&rng, 3, 13);
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+        bitmask_t buttons[13];
+        bitmask_t target = 0;
+        for (size_t b = 0; b < n_buttons; b++) {
+            buttons[b] = (bitmask_t) rng_range(&rng, 1, (1u << n_lights) - 1);
+            if (rng_chance(&rng, 50)) {
+                target ^= buttons[b];
+            }
+        }
 
-    for (size_t i = 0; i < data.n; i++) {
-        free_machine(&data.machines[i]);
+        fprintf(out, "[");
+        for (size_t l = 0; l < n_lights; l++) {
+            fputc(target & (1u << l) ? '#' : '.', out);
+        }
+        fprintf(out, "]");
+        for (size_t b = 0; b < n_buttons; b++) {
+            const char* sep = " (";
+            for (size_t l = 0; l < n_lights; l++) {
+                if (buttons[b] & (1u << l)) {
+                    fprintf(out, "%s%zu", sep, l);
+                    sep = ",";
+                }
+            }
+            fprintf(out, ")");
+        }
+        const char* sep = " {";
+        for (size_t l = 0; l < n_lights; l++) {
+            fprintf(out, "%s%" PRIu64, sep, rng_range(&rng, 1, 300));
+            sep = ",";
+        }
+        fprintf(out, "}\n");
     }
-    free(data.machines);
+    return !ferror(out);
+}
+
+const AocDay day10 = {
+    .name = "day10",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+};
+
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day10, argc, argv);
 }
+#endif
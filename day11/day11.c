@@ -1,10 +1,15 @@
-#include <errno.h>
 #include <stdbool.h>
 #include <stdio.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
+#include "aoc.h"
+#include "arena.h"
+#include "input.h"
+#include "rng.h"
+#include "scan.h"
+
 typedef struct {
     char* name;
     char** outs;
@@ -18,100 +23,91 @@ typedef struct {
 typedef struct {
     DeviceMap device_map;
     const size_t n_devices;
+    // owns the devices, their names and their outputs
+    Arena arena;
     const bool parse_successful;
 } Data;
 
-void free_devices(Device* devices, const size_t count) {
-    if (!devices) {
-        return;
+static Data parseFile(const char* path) {
+    Input input;
+    if (!input_open(&input, path)) {
+        return (Data) {
+            .device_map = {
+                .devices = NULL,
+                .count = 0,
+            },
+            .n_devices = 0,
+            .arena = { NULL, 0 },
+            .parse_successful = false,
+        };
     }
 
-    for (size_t i = 0; i < count; i++) {
-        if (devices[i].name) {
-            free(devices[i].name);
-        }
-
-        if (devices[i].outs) {
-            for (size_t j = 0; devices[i].outs[j]; j++) {
-                free(devices[i].outs[j]);
-            }
-            free(devices[i].outs);
-        }
-    }
-
-    free(devices);
-}
-
-Data parseFile(const char* path) {
-    FILE* fp = fopen(path, "r");
-    if (!fp) {
-        fprintf(stderr, "failed to open %s: %s\n", path, strerror(errno));
+    // one device per line, so the array is allocated exactly once. Every name is copied once, its
+    // '\0' taking the place of the ':', ' ' or '\n' after it, and each line's `outs` has a pointer
+    // per space plus its NULL, aligned; so one block of exactly that bound holds the whole parse
+    const size_t n_lines = input_count_lines(&input);
+    const size_t n_spaces = input_count_char(input.data, input.size, ' ');
+    Arena arena;
+    arena_init(&arena, (n_lines ? n_lines : 1) * sizeof(Device) + input.size + 1
+        + (n_spaces + n_lines) * sizeof(char*) + n_lines * (alignof(char*) - 1));
+    Device* devices = ARENA_NEW(&arena, Device, n_lines ? n_lines : 1);
+    size_t count = 0;
+    if (!devices) {
         goto error;
     }
 
-    Device* devices = NULL;
-    size_t count = 0;
+    size_t pos = 0;
+    Line line;
+    while (input_next_line(&input, &pos, &line)) {
+        if (!line.len) {
+            continue;
+        }
 
-    char* line = NULL;
-    size_t cap = 0;
-    while (getline(&line, &cap, fp) > 0) {
-        size_t len = strlen(line);
-        if (len > 0 && line[len - 1] == '\n') {
-            line[len - 1] = '\0';
+        const char* colon = scan_find(line.str, line.str + line.len, ':');
+        if (colon == line.str + line.len) {
+            goto error;
         }
 
-        char* colon = strchr(line, ':');
-        if (!colon) {
+        char* name = arena_strndup(&arena, line.str, (size_t) (colon - line.str));
+        if (!name) {
             goto error;
         }
 
-        *colon = '\0';
+        devices[count].name = name;
+        devices[count].outs = NULL;
+        count++;
 
-        char* name = strdup(line);
-        if (!name) {
+        const char* end = line.str + line.len;
+        const size_t n_tokens = input_count_char(colon + 1, (size_t) (end - colon - 1), ' ');
+        char** outs = ARENA_NEW(&arena, char*, n_tokens + 1);
+        if (!outs) {
             goto error;
         }
+        devices[count - 1].outs = outs;
 
-        char** outs = NULL;
         size_t n_outs = 0;
-
-        char* tok = strtok(colon + 2, " ");
-        while (tok) {
-            while (*tok == ' ') {
+        for (const char* tok = colon + 1; tok < end; ) {
+            while (tok < end && *tok == ' ') {
                 tok++;
             }
 
-            if (*tok) {
-                char** tmp = realloc(outs, (n_outs + 2) * sizeof(*outs));
-                if (!tmp) {
-                    goto error;
-                }
-                outs = tmp;
+            const char* tok_end = tok;
+            while (tok_end < end && *tok_end != ' ') {
+                tok_end++;
+            }
 
-                outs[n_outs] = strdup(tok);
+            if (tok_end > tok) {
+                outs[n_outs] = arena_strndup(&arena, tok, (size_t) (tok_end - tok));
                 if (!outs[n_outs]) {
                     goto error;
                 }
-
                 n_outs++;
-                outs[n_outs] = NULL;
             }
-
-            tok = strtok(NULL, " ");
+            tok = tok_end;
         }
-
-        Device* tmp = realloc(devices, (count + 1) * sizeof(*devices));
-        if (!tmp) {
-            goto error;
-        }
-        devices = tmp;
-
-        devices[count].name = name;
-        devices[count].outs = outs;
-        count++;
+        outs[n_outs] = NULL;
     }
-    free(line);
-    fclose(fp);
+    input_close(&input);
 
     return (Data) {
         .device_map = {
@@ -119,13 +115,13 @@ Data parseFile(const char* path) {
             .count = count,
         },
         .n_devices = count,
+        .arena = arena,
         .parse_successful = true,
     };
 
 error:
-    free(line);
-    fclose(fp);
-    free_devices(devices, count);
+    input_close(&input);
+    arena_free(&arena);
 
     return (Data) {
         .device_map = {
@@ -133,11 +129,12 @@ error:
             .count = 0,
         },
         .n_devices = 0,
+        .arena = { NULL, 0 },
         .parse_successful = false,
     };
 }
 
-Device* findDevice(const DeviceMap map, const char* name) {
+static Device* findDevice(const DeviceMap map, const char* name) {
     for (size_t i = 0; i < map.count; i++) {
         if (strcmp(map.devices[i].name, name) == 0) {
             return &map.devices[i];
@@ -146,12 +143,16 @@ Device* findDevice(const DeviceMap map, const char* name) {
     return NULL;
 }
 
-size_t countPaths(const DeviceMap map, const char* dev) {
+static size_t countPaths(const DeviceMap map, const char* dev) {
     if (strcmp(dev, "out") == 0) {
         return 1;
     }
 
+    // a device that is never listed (e.g. no "svr" in part 1's sample) leads nowhere
     const Device* device = findDevice(map, dev);
+    if (!device) {
+        return 0;
+    }
 
     size_t total = 0;
     for (size_t i = 0; device->outs[i]; i++) {
@@ -161,7 +162,7 @@ size_t countPaths(const DeviceMap map, const char* dev) {
     return total;
 }
 
-size_t part1(const Data* data) {
+static size_t part1(const Data* data) {
     return countPaths(data->device_map, "you");
 }
 
@@ -170,7 +171,7 @@ typedef struct {
     const size_t n_devices;
 } Memo;
 
-Memo memo_create(const size_t n_devices) {
+static Memo memo_create(const size_t n_devices) {
     size_t*** table = malloc(n_devices * sizeof(*table));
     if (!table) {
         return (Memo) { .table = NULL, .n_devices = 0 };
@@ -220,7 +221,7 @@ error:
     return (Memo) { .table = NULL, .n_devices = 0 };
 }
 
-void free_memo(Memo* memo) {
+static void free_memo(Memo* memo) {
     for (size_t i = 0; i < memo->n_devices; i++) {
         for (size_t d = 0; d < 2; d++) {
             free(memo->table[i][d]);
@@ -231,7 +232,7 @@ void free_memo(Memo* memo) {
     free(memo->table);
 }
 
-size_t countPaths_memo(
+static size_t countPaths_memo(
     const DeviceMap map,
     const char* dev,
     bool seen_dac,
@@ -254,6 +255,9 @@ size_t countPaths_memo(
     }
 
     const Device* device = findDevice(map, dev);
+    if (!device) {
+        return 0;
+    }
 
     size_t* cached = &memo->table[(size_t) (device - map.devices)][seen_dac][seen_fft];
     if (*cached != SIZE_MAX) {
@@ -269,7 +273,7 @@ size_t countPaths_memo(
     return total;
 }
 
-size_t part2(const Data* data) {
+static size_t part2(const Data* data) {
     Memo memo = memo_create(data->n_devices);
 
     const size_t result = countPaths_memo(data->device_map, "svr", false, false, &memo);
@@ -278,20 +282,123 @@ size_t part2(const Data* data) {
     return result;
 }
 
-int main(void) {
-    const char* path = "inputs/day11.txt";
+static void freeData(const Data* data) {
+    Arena arena = data->arena;
+    arena_free(&arena);
+}
 
+static void* parse(const char* path) {
     const Data data = parseFile(path);
     if (!data.parse_successful) {
-        fprintf(stderr, "Unable to parse '%s'\n", path);
-        return 1;
+        return NULL;
     }
 
-    const size_t p1 = part1(&data);
-    printf("Part 1: %zu\n", p1);
+    Data* boxed = aoc_box(&data, sizeof(data));
+    if (!boxed) {
+        perror("Out of memory.");
+        freeData(&data);
+    }
+    return boxed;
+}
+
+static size_t solvePart1(const void* data) {
+    return part1(data);
+}
+
+static size_t solvePart2(const void* data) {
+    return part2(data);
+}
 
-    const size_t p2 = part2(&data);
-    printf("Part 2: %zu\n", p2);
+static void release(void* data) {
+    freeData(data);
+    free(data);
+}
+
+// a DAG of `size` devices (at least 12) in shuffled order: a chain through every device keeps
+// "svr" -> "fft" -> "dac" -> "out" connected, extra edges only point a short way ahead, and
+// "you" sits close to the end so the unmemoised part 1 stays tractable
+static void deviceName(char* name, const size_t id, const size_t n_devices) {
+    static const char* const fixed[] = { "svr", "fft", "dac", "you" };
+    const size_t fixed_at[] = { 0, n_devices / 3, 2 * n_devices / 3, n_devices - (n_devices / 4 < 12 ? n_devices / 4 : 12) };
+    for (size_t i = 0; i < 4; i++) {
+        if (id == fixed_at[i]) {
+            strcpy(name, fixed[i]);
+            return;
+        }
+    }
+
+    // every other device gets a unique name one letter longer than any reserved one
+    size_t len = 4;
+    for (size_t capacity = 26 * 26 * 26 * 26; capacity < n_devices; capacity *= 26) {
+        len++;
+    }
+    size_t rest = id;
+    for (size_t i = len; i > 0; i--) {
+        name[i - 1] = (char) ('a' + rest % 26);
+        rest /= 26;
+    }
+    name[len] = '\0';
+}
+
+static bool generate(FILE* out, const size_t size, const uint64_t seed) {
+    const size_t n_devices = size < 12 ? 12 : size;
+    size_t* order = malloc(sizeof(size_t) * n_devices);
+    if (!order) {
+        perror("Out of memory.");
+        return false;
+    }
+
+    Rng rng = rng_seed(seed);
+    for (size_t i = 0; i < n_devices; i++) {
+        order[i] = i;
+    }
+    for (size_t i = n_devices - 1; i > 0; i--) {
+        const size_t j = rng_range(&rng, 0, i);
+        const size_t tmp = order[i];
+        order[i] = order[j];
+        order[j] = tmp;
+    }
+
+    char name[32];
+    for (size_t i = 0; i < n_devices; i++) {
+        const size_t id = order[i];
+        deviceName(name, id, n_devices);
+        fprintf(out, "%s:", name);
+
+        if (id == n_devices - 1) {
+            fprintf(out, " out\n");
+            continue;
+        }
+
+        deviceName(name, id + 1, n_devices);
+        fprintf(out, " %s", name);
+        for (size_t extra = rng_range(&rng, 0, 2); extra > 0; extra--) {
+            const size_t to = id + rng_range(&rng, 2, 8);
+            if (to >= n_devices) {
+                fprintf(out, " out");
+                break;
+            }
+            deviceName(name, to, n_devices);
+            fprintf(out, " %s", name);
+        }
+        fprintf(out, "\n");
+    }
+
+    free(order);
+    return !ferror(out);
+}
 
-    free_devices(data.device_map.devices, data.n_devices);
+const AocDay day11 = {
+    .name = "day11",
+    .parse = parse,
+    .part1 = solvePart1,
+    .part2 = solvePart2,
+    .release = release,
+    .generate = generate,
+};
+
+#ifndef AOC_RUNNER
+int main(int argc, char** argv) {
+    return aoc_day_main(&day11, argc, argv);
 }
+#endif
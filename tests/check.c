@@ -0,0 +1,390 @@
+#include <inttypes.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "aoc.h"
+#include "scan.h"
+
+// Golden-answer regression check: the reference solvers (scalar scanning, no variant) must
+// reproduce the recorded answers for inputs/, and every scanner level and every solver variant
+// must agree with the reference on those inputs and on generated ones. Variants with option
+// sets to check are also run with each of them.
+
+typedef struct {
+    char name[64];
+    size_t p1, p2;
+    // the day's puzzle parameters for this input, if they differ from the defaults
+    char options[192];
+} Golden;
+
+typedef struct {
+    size_t p1, p2;
+} Answers;
+
+typedef struct {
+    const char* input_dir;
+    Golden* golden;
+    size_t n_golden;
+    const size_t* sizes;
+    size_t n_sizes;
+    size_t n_seeds;
+    bool verbose;
+    size_t checks, failures;
+} Check;
+
+static const size_t DEFAULT_SIZES[] = { 1, 8, 40 };
+
+static bool readGolden(const char* path, Golden** golden, size_t* n_golden) {
+    FILE* in = fopen(path, "r");
+    if (!in) {
+        perror(path);
+        return false;
+    }
+
+    size_t capacity = 32, n = 0;
+    Golden* entries = malloc(capacity * sizeof(Golden));
+    if (!entries) {
+        perror("Out of memory.");
+        fclose(in);
+        return false;
+    }
+
+    char line[256];
+    while (fgets(line, sizeof(line), in)) {
+        if (line[0] == '#' || line[0] == '\n') {
+            continue;
+        }
+        if (n == capacity) {
+            Golden* new = realloc(entries, capacity * 2 * sizeof(Golden));
+            if (!new) {
+                perror("Out of memory.");
+                free(entries);
+                fclose(in);
+                return false;
+            }
+            entries = new;
+            capacity *= 2;
+        }
+
+        Golden* entry = &entries[n];
+        int end = 0;
+        if (sscanf(line, "%63s %zu %zu %n", entry->name, &entry->p1, &entry->p2, &end) != 3 || !end) {
+            fprintf(stderr, "%s: malformed line '%s'\n", path, line);
+            free(entries);
+            fclose(in);
+            return false;
+        }
+        snprintf(entry->options, sizeof(entry->options), "%s", line + end);
+        entry->options[strcspn(entry->options, "\n")] = '\0';
+        n++;
+    }
+    fclose(in);
+
+    *golden = entries;
+    *n_golden = n;
+    return true;
+}
+
+static const Golden* findGolden(const Check* check, const char* name) {
+    for (size_t i = 0; i < check->n_golden; i++) {
+        if (strcmp(check->golden[i].name, name) == 0) {
+            return &check->golden[i];
+        }
+    }
+    return NULL;
+}
+
+static bool solve(const AocDay* day, const char* path, Answers* answers) {
+    void* data = day->parse(path);
+    if (!data) {
+        return false;
+    }
+    answers->p1 = day->part1(data);
+
+    if (day->parse_part2) {
+        void* data2 = day->parse_part2(path);
+        if (!data2) {
+            day->release(data);
+            return false;
+        }
+        answers->p2 = day->part2(data2);
+        day->release_part2(data2);
+    } else {
+        answers->p2 = day->part2(data);
+    }
+
+    day->release(data);
+    return true;
+}
+
+static void compare(Check* check, const char* day, const char* input, const char* against, const char* solver,
+                    const Answers* expected, const Answers* actual) {
+    const size_t values[2][2] = { { expected->p1, actual->p1 }, { expected->p2, actual->p2 } };
+    for (size_t part = 0; part < 2; part++) {
+        check->checks++;
+        if (values[part][0] != values[part][1]) {
+            check->failures++;
+            printf("FAIL %s %s part %zu: %s says %zu, %s says %zu\n", day, input, part + 1, against, values[part][0], solver, values[part][1]);
+        } else if (check->verbose) {
+            printf("ok   %s %s part %zu: %s == %s (%zu)\n", day, input, part + 1, solver, against, values[part][1]);
+        }
+    }
+}
+
+static void fail(Check* check, const char* day, const char* input, const char* solver) {
+    check->checks++;
+    check->failures++;
+    printf("FAIL %s %s: %s could not parse the input\n", day, input, solver);
+}
+
+// applies a space separated set of options through `configure`; false, saying which, for one it doesn't take
+static bool configureSet(const char* day, const char* solver, bool (*configure)(const char*), const char* set) {
+    char options[256];
+    snprintf(options, sizeof(options), "%s", set);
+
+    char* save;
+    for (char* option = strtok_r(options, " ", &save); option; option = strtok_r(NULL, " ", &save)) {
+        if (!configure || !configure(option)) {
+            printf("FAIL %s %s: no option '%s'\n", day, solver, option);
+            return false;
+        }
+    }
+    return true;
+}
+
+// the variant's answers with the option set; every option goes back to its default afterwards
+static bool solveWith(const AocDay* day, const AocVariant* variant, const char* set, const char* also, const char* path, Answers* answers) {
+    const bool solved = configureSet(day->name, variant->name, variant->configure, set)
+        && (!also || configureSet(day->name, variant->name, variant->configure, also)) && solve(day, path, answers);
+    variant->configure(NULL);
+    return solved;
+}
+
+// the variant under each of its option sets against the same set plus `check_against`, or the reference
+static void checkOptions(Check* check, const AocDay* day, const AocVariant* variant, const AocDay* solver,
+                         const char* path, const char* label, const Answers* reference) {
+    for (const char* const* set = variant->checks; *set; set++) {
+        char name[256], against[256];
+        snprintf(name, sizeof(name), "%s[%s]", variant->name, *set);
+        snprintf(against, sizeof(against), "%s[%s %s]", variant->name, *set, variant->check_against ? variant->check_against : "");
+
+        Answers expected = *reference;
+        if (variant->check_against && !solveWith(solver, variant, *set, variant->check_against, path, &expected)) {
+            fail(check, day->name, label, against);
+            continue;
+        }
+
+        Answers answers;
+        if (solveWith(solver, variant, *set, NULL, path, &answers)) {
+            compare(check, day->name, label, variant->check_against ? against : "reference", name, &expected, &answers);
+        } else {
+            fail(check, day->name, label, name);
+        }
+    }
+}
+
+static void checkInputWith(Check* check, const AocDay* day, const char* path, const char* label, const Golden* golden);
+
+// the whole check of one input, with the golden entry's puzzle parameters set for all of it
+static void checkInput(Check* check, const AocDay* day, const char* path, const char* label, const Golden* golden) {
+    if (golden && golden->options[0]) {
+        if (!configureSet(day->name, "reference", day->configure, golden->options)) {
+            fail(check, day->name, label, "golden options");
+            return;
+        }
+        checkInputWith(check, day, path, label, golden);
+        day->configure(NULL);
+        return;
+    }
+    checkInputWith(check, day, path, label, golden);
+}
+
+static void checkInputWith(Check* check, const AocDay* day, const char* path, const char* label, const Golden* golden) {
+    const ScanIsa best = scan_isa();
+
+    // the reference is the plain solver on the plain byte loops
+    scan_use(SCAN_SCALAR);
+    Answers reference;
+    const bool parsed = solve(day, path, &reference);
+    scan_use(best);
+    if (!parsed) {
+        fail(check, day->name, label, "reference");
+        return;
+    }
+
+    if (golden) {
+        const Answers expected = { golden->p1, golden->p2 };
+        compare(check, day->name, label, "golden", "reference", &expected, &reference);
+    }
+
+    for (ScanIsa isa = SCAN_SSE42; isa <= SCAN_AVX2; isa++) {
+        if (!scan_use(isa)) {
+            continue;
+        }
+        Answers answers;
+        if (solve(day, path, &answers)) {
+            compare(check, day->name, label, "reference", scan_isa_name(isa), &reference, &answers);
+        } else {
+            fail(check, day->name, label, scan_isa_name(isa));
+        }
+    }
+    scan_use(best);
+
+    // variants may pick their own kernels by scanner level, so each runs on every level
+    for (size_t v = 0; v < day->n_variants; v++) {
+        AocDay variant;
+        aoc_day_variant(day, day->variants[v].name, &variant);
+
+        for (ScanIsa isa = SCAN_SCALAR; isa <= SCAN_AVX2; isa++) {
+            if (!scan_use(isa)) {
+                continue;
+            }
+            char solver[64];
+            snprintf(solver, sizeof(solver), "%s/%s", day->variants[v].name, scan_isa_name(isa));
+
+            Answers answers;
+            if (solve(&variant, path, &answers)) {
+                compare(check, day->name, label, "reference", solver, &reference, &answers);
+            } else {
+                fail(check, day->name, label, solver);
+            }
+        }
+        scan_use(best);
+
+        if (day->variants[v].checks) {
+            checkOptions(check, day, &day->variants[v], &variant, path, label, &reference);
+        }
+    }
+}
+
+static void checkGenerated(Check* check, const AocDay* day, const size_t size, const uint64_t seed) {
+    const char* tmpdir = getenv("TMPDIR");
+    char path[4096];
+    snprintf(path, sizeof(path), "%s/aoc_%s_XXXXXX", tmpdir && *tmpdir ? tmpdir : "/tmp", day->name);
+
+    char label[64];
+    snprintf(label, sizeof(label), "generated(%zu, %" PRIu64 ")", size, seed);
+
+    const int fd = mkstemp(path);
+    FILE* out = fd >= 0 ? fdopen(fd, "w") : NULL;
+    if (!out) {
+        perror(path);
+        if (fd >= 0) {
+            close(fd);
+            unlink(path);
+        }
+        fail(check, day->name, label, "generator");
+        return;
+    }
+
+    const bool generated = day->generate(out, size, seed);
+    if (fclose(out) != 0 || !generated) {
+        unlink(path);
+        fail(check, day->name, label, "generator");
+        return;
+    }
+
+    checkInput(check, day, path, label, NULL);
+    unlink(path);
+}
+
+static void checkDay(Check* check, const AocDay* day) {
+    const char* suffixes[] = { "_sample", "" };
+    for (size_t i = 0; i < sizeof(suffixes) / sizeof(*suffixes); i++) {
+        char name[64], path[4096];
+        snprintf(name, sizeof(name), "%s%s.txt", day->name, suffixes[i]);
+        snprintf(path, sizeof(path), "%s/%s", check->input_dir, name);
+
+        struct stat st;
+        if (stat(path, &st) != 0) {
+            continue;
+        }
+
+        const Golden* golden = findGolden(check, name);
+        if (!golden && check->n_golden) {
+            printf("note %s %s: no golden answers, only comparing against the reference\n", day->name, name);
+        }
+        checkInput(check, day, path, name, golden);
+    }
+
+    for (size_t s = 0; s < check->n_sizes; s++) {
+        for (uint64_t seed = 1; seed <= check->n_seeds; seed++) {
+            checkGenerated(check, day, check->sizes[s], seed);
+        }
+    }
+}
+
+static void usage(const char* argv0) {
+    fprintf(stderr,
+        "usage: %s [-v] [-d input_dir] [-g golden] [-s sizes] [-n seeds] [day|from-to ...]\n"
+        "  checks the reference solvers against the golden answers and every scanner level and\n"
+        "  variant against the reference, on inputs/ and on generated inputs; exits 1 on any mismatch\n"
+        "  -g  file of '<input> <part 1> <part 2> [key=value ...]' lines for the files in input_dir, the\n"
+        "      options being the day's puzzle parameters for that input\n"
+        "  -s  comma separated generated input sizes (default 1,8,40), -s 0 for none\n"
+        "  -n  seeds per generated size (default 2)\n"
+        "  -v  list every comparison, not just the failures\n",
+        argv0);
+}
+
+int main(int argc, char** argv) {
+    Check check = { .input_dir = "inputs", .sizes = DEFAULT_SIZES, .n_sizes = sizeof(DEFAULT_SIZES) / sizeof(*DEFAULT_SIZES), .n_seeds = 2 };
+    const char* golden_path = NULL;
+    size_t sizes[64];
+    bool selected[AOC_N_DAYS] = { false };
+    bool any_selected = false;
+
+    for (int i = 1; i < argc; i++) {
+        const char* arg = argv[i];
+        if (strcmp(arg, "-d") == 0 && i + 1 < argc) {
+            check.input_dir = argv[++i];
+        } else if (strcmp(arg, "-g") == 0 && i + 1 < argc) {
+            golden_path = argv[++i];
+        } else if (strcmp(arg, "-s") == 0 && i + 1 < argc) {
+            size_t n = 0;
+            for (char* size = argv[++i]; *size && n < sizeof(sizes) / sizeof(sizes[0]); ) {
+                const size_t value = (size_t) strtoull(size, &size, 10);
+                if (value) {
+                    sizes[n++] = value;
+                }
+                if (*size == ',') {
+                    size++;
+                }
+            }
+            check.sizes = sizes;
+            check.n_sizes = n;
+        } else if (strcmp(arg, "-n") == 0 && i + 1 < argc) {
+            check.n_seeds = (size_t) strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(arg, "-v") == 0) {
+            check.verbose = true;
+        } else if (strcmp(arg, "-h") == 0 || strcmp(arg, "--help") == 0) {
+            usage(argv[0]);
+            return 0;
+        } else if (aoc_select_days(arg, selected)) {
+            any_selected = true;
+        } else {
+            fprintf(stderr, "invalid argument '%s'\n", arg);
+            usage(argv[0]);
+            return 1;
+        }
+    }
+
+    if (golden_path && !readGolden(golden_path, &check.golden, &check.n_golden)) {
+        return 1;
+    }
+
+    for (size_t d = 0; d < AOC_N_DAYS; d++) {
+        if (!any_selected || selected[d]) {
+            checkDay(&check, AOC_DAYS[d]);
+        }
+    }
+    free(check.golden);
+
+    printf("%zu of %zu checks passed\n", check.checks - check.failures, check.checks);
+    return check.failures ? 1 : 0;
+}